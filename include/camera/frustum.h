@@ -0,0 +1,54 @@
+#ifndef __hemlock_camera_frustum_h
+#define __hemlock_camera_frustum_h
+
+namespace hemlock {
+    namespace camera {
+        /**
+         * @brief The six clipping planes of a camera, in world
+         * space, extracted from its view-projection matrix.
+         *
+         * Each plane is stored as (normal, distance) with the
+         * normal pointing into the frustum, such that a point p
+         * is inside the plane when dot(normal, p) + distance is
+         * non-negative.
+         */
+        class Frustum {
+        public:
+            Frustum()  { /* Empty. */ }
+            ~Frustum() { /* Empty. */ }
+
+            /**
+             * @brief Sets the planes of the frustum from the given
+             * view-projection matrix.
+             *
+             * @param view_projection The view-projection matrix
+             * of the camera.
+             */
+            void update(const f32m4& view_projection);
+
+            /**
+             * @brief Determines if an axis-aligned box is at least
+             * partly within the frustum. This is conservative:
+             * some boxes just outside a corner of the frustum will
+             * be reported as within it.
+             *
+             * @param min The minimum corner of the box.
+             * @param max The maximum corner of the box.
+             * @return True if the box may be within the frustum,
+             * false if it certainly is not.
+             */
+            bool intersects(const f32v3& min, const f32v3& max) const;
+
+            /**
+             * @brief The planes of the frustum: left, right, bottom,
+             * top, near and far.
+             */
+            const f32v4* planes() const { return m_planes; }
+        protected:
+            f32v4 m_planes[6];
+        };
+    }
+}
+namespace hcam = hemlock::camera;
+
+#endif // __hemlock_camera_frustum_h
@@ -0,0 +1,108 @@
+#ifndef __hemlock_physics_task_scheduler_h
+#define __hemlock_physics_task_scheduler_h
+
+#include <bullet/LinearMath/btThreads.h>
+
+#include "thread/thread_pool.hpp"
+
+namespace hemlock {
+    namespace physics {
+        using PhysicsThreadPool = thread::ThreadPool<thread::BasicThreadContext>;
+
+        /**
+         * @brief Work shared between the thread calling into the
+         * scheduler and the tasks it adds to its thread pool, each
+         * taking a grain of the range at a time until none is left.
+         *
+         * Held by handle, as tasks may still be dequeued after the
+         * call that made the work has returned, at which point they
+         * find no range left and so never touch the loop body.
+         */
+        struct ParallelWork {
+            std::atomic<int>            next;
+            int                         end;
+            int                         grain_size;
+            std::atomic<int>            remaining;
+            const btIParallelForBody*   for_body;
+            const btIParallelSumBody*   sum_body;
+            std::atomic<btScalar>       sum;
+
+            /**
+             * @brief Runs grains of the range until none is left.
+             */
+            void run();
+        };
+
+        /**
+         * @brief Bullet task scheduler running the parallel loops
+         * of a multithreaded world on a thread pool of its own.
+         *
+         * The pool is kept apart from those used for chunk tasks,
+         * and sized by the caller, so that stepping physics takes
+         * only the cores set aside for it. Its threads sleep on the
+         * pool's queue between loops.
+         *
+         * The thread calling into the scheduler, usually that
+         * stepping the world, takes grains of each loop alongside
+         * the pool and blocks on the rest to finish, such that a
+         * scheduler with a pool of N threads runs loops across
+         * N + 1 threads.
+         *
+         * NOTE: loops begun within a loop, as well as loops begun
+         * while another thread is in the midst of one, are run on
+         * the thread calling into the scheduler alone.
+         */
+        class ThreadPoolTaskScheduler : public btITaskScheduler {
+        public:
+            ThreadPoolTaskScheduler();
+            virtual ~ThreadPoolTaskScheduler() { /* Empty. */ }
+
+            /**
+             * @brief Initialises the scheduler, starting its thread
+             * pool.
+             *
+             * @param thread_count The number of threads in the
+             * pool, not counting the thread calling into the
+             * scheduler.
+             */
+            void init(ui32 thread_count);
+            /**
+             * @brief Disposes of the scheduler, bringing its
+             * threads to a stop.
+             */
+            void dispose();
+
+            virtual int getMaxNumThreads() const override { return static_cast<int>(m_pool_thread_count) + 1; }
+            virtual int getNumThreads() const override { return static_cast<int>(m_thread_count); }
+            virtual void setNumThreads(int thread_count) override;
+
+            virtual void parallelFor(
+                                      int  begin,
+                                      int  end,
+                                      int  grain_size,
+                const btIParallelForBody&  body
+            ) override;
+            virtual btScalar parallelSum(
+                                      int  begin,
+                                      int  end,
+                                      int  grain_size,
+                const btIParallelSumBody&  body
+            ) override;
+        protected:
+            /**
+             * @brief Runs the work across as many threads as the
+             * scheduler is set to use, returning once all of the
+             * work is done.
+             */
+            void run(hmem::Handle<ParallelWork> work);
+
+            PhysicsThreadPool   m_thread_pool;
+            ui32                m_pool_thread_count;
+            ui32                m_thread_count;
+            std::atomic<bool>   m_running;
+        };
+    }
+}
+namespace hphys = hemlock::physics;
+
+#endif // __hemlock_physics_task_scheduler_h
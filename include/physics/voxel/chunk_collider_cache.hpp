@@ -0,0 +1,140 @@
+#ifndef __hemlock_physics_voxel_chunk_collider_cache_hpp
+#define __hemlock_physics_voxel_chunk_collider_cache_hpp
+
+#include <bullet/BulletCollision/CollisionShapes/btBoxShape.h>
+#include <bullet/BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <bullet/BulletDynamics/Dynamics/btDynamicsWorld.h>
+#include <bullet/BulletDynamics/Dynamics/btRigidBody.h>
+
+#include "physics/voxel/chunk_grid_shape.hpp"
+
+namespace hemlock {
+    namespace voxel {
+        struct Chunk;
+    }
+
+    namespace physics {
+        /**
+         * @brief A solid cuboid of blocks within a chunk, spanning
+         * start to end inclusive.
+         */
+        struct ChunkColliderCuboid {
+            hvox::BlockChunkPosition start, end;
+        };
+        using ChunkColliderCuboids = std::vector<ChunkColliderCuboid>;
+
+        /**
+         * @brief Holds a static body per chunk of a chunk grid,
+         * whose shape is a compound of boxes over the solid blocks
+         * of that chunk, merged greedily into as few cuboids as
+         * can be found.
+         *
+         * Bodies are built as chunks are loaded and rebuilt only as
+         * their blocks change, rather than shapes being gathered
+         * about each body every step, and so collision with the
+         * grid costs a broadphase proxy per chunk and the few boxes
+         * near each contact, found through the compound's own tree.
+         *
+         * A block is taken to be solid if the prototype given it by
+         * the evaluator fills the block. Blocks whose prototypes do
+         * not are left out, a ChunkGridShape being needed where such
+         * blocks are to be collided with.
+         *
+         * NOTE: this must be initialised before chunks are loaded
+         * into the grid, as it can only subscribe to the events of
+         * chunks as they are preloaded. It, and the world it adds
+         * bodies to, must be updated on the thread owning the grid.
+         */
+        template <VoxelPrototypeEvaluator PrototypeEvaluator>
+        class ChunkColliderCache {
+        public:
+            ChunkColliderCache();
+            ~ChunkColliderCache() { /* Empty. */ }
+
+            /**
+             * @brief Initialises the cache, subscribing to the
+             * preloading of chunks by the grid.
+             *
+             * @param chunk_grid The chunk grid to hold bodies for.
+             * @param world The world to add the bodies to.
+             * @param friction The friction of the bodies.
+             */
+            void init( hmem::Handle<hvox::ChunkGrid> chunk_grid,
+                                     btDynamicsWorld* world,
+                                            btScalar friction = 1.0f );
+            /**
+             * @brief Disposes of the cache, removing all bodies
+             * from the world and unsubscribing from the grid and
+             * its chunks.
+             *
+             * NOTE: no chunk tasks may be running during this
+             * call, as chunk events are not thread-safe.
+             */
+            void dispose();
+
+            /**
+             * @brief Rebuilds the bodies of chunks loaded or
+             * changed since the last call, once each. Bodies of
+             * chunks unloaded are removed as they are unloaded.
+             */
+            void update();
+
+            /**
+             * @brief Merges the solid blocks of a chunk into
+             * cuboids.
+             *
+             * @param chunk The chunk whose blocks to merge, the
+             * caller holding at least a shared lock on its blocks.
+             * @param cuboids Set to the cuboids found.
+             */
+            static void build_cuboids(const hvox::Chunk& chunk, OUT ChunkColliderCuboids& cuboids);
+        protected:
+            struct ChunkBody {
+                hmem::WeakHandle<hvox::Chunk>   chunk;
+                btCompoundShape*                shape;
+                btRigidBody*                    body;
+            };
+            using ChunkBodies = std::unordered_map<hvox::ChunkID, ChunkBody>;
+
+            struct HandleAndID {
+                hmem::WeakHandle<hvox::Chunk>   handle;
+                hvox::ChunkID                   id;
+            };
+            using ChunkQueue = moodycamel::ConcurrentQueue<HandleAndID>;
+
+            /**
+             * @brief Gets the box of the given extent in blocks,
+             * shared between all cuboids of that extent.
+             */
+            btBoxShape* box_shape(ui32v3 extent);
+
+            /**
+             * @brief Rebuilds the body of the chunk from its blocks,
+             * removing it from the world if the chunk has no solid
+             * blocks.
+             */
+            void rebuild_body(hmem::Handle<hvox::Chunk> chunk, ChunkBody& chunk_body);
+            void remove_body(ChunkBody& chunk_body);
+
+            Subscriber<hmem::Handle<hvox::Chunk>>       handle_chunk_preload;
+            Subscriber<>                                handle_chunk_change;
+            Subscriber<hvox::BlockChangeEvent>          handle_block_change;
+            Subscriber<hvox::BulkBlockChangeEvent>      handle_bulk_block_change;
+            Subscriber<>                                handle_chunk_unload;
+
+            hmem::WeakHandle<hvox::ChunkGrid>   m_chunk_grid;
+            btDynamicsWorld*                    m_world;
+            btScalar                            m_friction;
+
+            ChunkBodies m_bodies;
+            ChunkQueue  m_dirty_queue;
+
+            std::unordered_map<ui32, std::unique_ptr<btBoxShape>> m_box_shapes;
+        };
+    }
+}
+namespace hphys = hemlock::physics;
+
+#include "chunk_collider_cache.inl"
+
+#endif // __hemlock_physics_voxel_chunk_collider_cache_hpp
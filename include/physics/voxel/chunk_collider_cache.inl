@@ -0,0 +1,298 @@
+#include "voxel/chunk.h"
+#include "voxel/chunk/grid.h"
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+hphys::ChunkColliderCache<PrototypeEvaluator>::ChunkColliderCache() :
+    handle_chunk_preload(Subscriber<hmem::Handle<hvox::Chunk>>{
+        [&](Sender, hmem::Handle<hvox::Chunk> chunk) {
+            // NOTE(Matthew): on_mesh_change is not listened to, as
+            //                chunks whose meshes are skipped, such as
+            //                those enclosed on all sides, still want
+            //                bodies, and remeshes follow the changes
+            //                to blocks we already listen to.
+            chunk->on_load                  += &handle_chunk_change;
+            chunk->on_block_changed         += &handle_block_change;
+            chunk->on_bulk_block_changed    += &handle_bulk_block_change;
+            chunk->on_unload                += &handle_chunk_unload;
+
+            auto it = m_bodies.find(chunk->id());
+            if (it != m_bodies.end()) remove_body(it->second);
+
+            m_bodies[chunk->id()] = ChunkBody{ chunk, nullptr, nullptr };
+        }
+    }),
+    handle_chunk_change(Subscriber<>{
+        [&](Sender sender) {
+            hmem::WeakHandle<hvox::Chunk> handle = sender.get_handle<hvox::Chunk>();
+
+            auto chunk = handle.lock();
+            // If chunk is nullptr, then there's no point
+            // handling the change as we will have an
+            // unload event for this chunk.
+            if (chunk == nullptr) return;
+
+            m_dirty_queue.enqueue({ handle, chunk->id() });
+        }
+    }),
+    handle_block_change(Subscriber<hvox::BlockChangeEvent>{
+        [&](Sender sender, hvox::BlockChangeEvent) {
+            handle_chunk_change(sender);
+        }
+    }),
+    handle_bulk_block_change(Subscriber<hvox::BulkBlockChangeEvent>{
+        [&](Sender sender, hvox::BulkBlockChangeEvent) {
+            handle_chunk_change(sender);
+        }
+    }),
+    // NOTE(Matthew): chunks are only unloaded on the thread owning
+    //                the grid, so the body is removed there and then,
+    //                before a chunk of the same ID can be preloaded.
+    handle_chunk_unload(Subscriber<>{
+        [&](Sender sender) {
+            hmem::WeakHandle<hvox::Chunk> handle = sender.get_handle<hvox::Chunk>();
+
+            auto chunk = handle.lock();
+            // If chunk is nullptr, then we have
+            // a major problem. on_unload MUST
+            // complete before chunk is released.
+            assert(chunk != nullptr);
+
+            auto it = m_bodies.find(chunk->id());
+            if (it == m_bodies.end()) return;
+
+            remove_body(it->second);
+
+            m_bodies.erase(it);
+        }
+    }),
+    m_world(nullptr),
+    m_friction(1.0f)
+{ /* Empty. */ }
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkColliderCache<PrototypeEvaluator>::init(
+    hmem::Handle<hvox::ChunkGrid> chunk_grid,
+                 btDynamicsWorld* world,
+                        btScalar friction /*= 1.0f*/
+) {
+    m_chunk_grid = chunk_grid;
+    m_world      = world;
+    m_friction   = friction;
+
+    chunk_grid->on_chunk_preload += &handle_chunk_preload;
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkColliderCache<PrototypeEvaluator>::dispose() {
+    auto chunk_grid = m_chunk_grid.lock();
+    if (chunk_grid != nullptr) chunk_grid->on_chunk_preload -= &handle_chunk_preload;
+
+    for (auto& [id, chunk_body] : m_bodies) {
+        remove_body(chunk_body);
+
+        auto chunk = chunk_body.chunk.lock();
+        if (chunk == nullptr) continue;
+
+        chunk->on_load                  -= &handle_chunk_change;
+        chunk->on_block_changed         -= &handle_block_change;
+        chunk->on_bulk_block_changed    -= &handle_bulk_block_change;
+        chunk->on_unload                -= &handle_chunk_unload;
+    }
+
+    ChunkBodies().swap(m_bodies);
+
+    HandleAndID handle_and_id;
+    while (m_dirty_queue.try_dequeue(handle_and_id));
+
+    m_box_shapes.clear();
+
+    m_world = nullptr;
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkColliderCache<PrototypeEvaluator>::update() {
+    HandleAndID handle_and_id;
+
+    // A chunk may be queued more than once, but its body
+    // need only be rebuilt the once.
+    std::unordered_set<hvox::ChunkID> rebuilt_chunks;
+    while (m_dirty_queue.try_dequeue(handle_and_id)) {
+        if (!rebuilt_chunks.insert(handle_and_id.id).second) continue;
+
+        auto it = m_bodies.find(handle_and_id.id);
+        if (it == m_bodies.end()) continue;
+
+        auto chunk = handle_and_id.handle.lock();
+
+        // The chunk may have been unloaded since being queued,
+        // and another preloaded with the same ID.
+        if (chunk == nullptr || chunk != it->second.chunk.lock()) continue;
+
+        rebuild_body(chunk, it->second);
+    }
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkColliderCache<PrototypeEvaluator>::build_cuboids(
+    const hvox::Chunk& chunk,
+    OUT ChunkColliderCuboids& cuboids
+) {
+    cuboids.clear();
+
+    const hvox::ChunkBlockStorage& blocks = chunk.blocks;
+
+    if (blocks.is_empty()) return;
+
+    const PrototypeEvaluator prototype_of = {};
+
+    auto is_solid = [&](hvox::Block block) {
+        if (block == hvox::NULL_BLOCK) return false;
+
+        const VoxelShapePrototype* prototype = prototype_of(block);
+
+        return prototype != nullptr && prototype->fills_block;
+    };
+
+    if (blocks.is_uniform()) {
+        if (is_solid(blocks.uniform_block())) {
+            cuboids.emplace_back(ChunkColliderCuboid{
+                hvox::BlockChunkPosition{0},
+                hvox::BlockChunkPosition{CHUNK_LENGTH - 1}
+            });
+        }
+
+        return;
+    }
+
+    // Blocks are cleared from this as they are taken into
+    // cuboids, so that each is taken only the once.
+    bool* solid = new bool[CHUNK_VOLUME];
+    for (hvox::BlockIndex idx = 0; idx < CHUNK_VOLUME; ++idx) {
+        solid[idx] = is_solid(blocks[idx]);
+    }
+
+    auto all_solid = [&](hvox::BlockChunkPosition start, hvox::BlockChunkPosition end) {
+        for (ui32 z = start.z; z <= end.z; ++z) {
+            for (ui32 y = start.y; y <= end.y; ++y) {
+                for (ui32 x = start.x; x <= end.x; ++x) {
+                    if (!solid[x + y * CHUNK_LENGTH + z * CHUNK_AREA]) return false;
+                }
+            }
+        }
+
+        return true;
+    };
+
+    /*
+     * Each solid block not yet taken starts a cuboid, which is
+     * grown as far as it will go along X, then Z, then Y, in the
+     * same manner as the greedy mesher.
+     */
+    for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+        for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+            for (ui32 x = 0; x < CHUNK_LENGTH; ++x) {
+                if (!solid[x + y * CHUNK_LENGTH + z * CHUNK_AREA]) continue;
+
+                const hvox::BlockChunkPosition start = hvox::BlockChunkPosition{x, y, z};
+                hvox::BlockChunkPosition       end   = start;
+
+                while (end.x + 1 < CHUNK_LENGTH
+                        && solid[(end.x + 1) + y * CHUNK_LENGTH + z * CHUNK_AREA]) ++end.x;
+
+                while (end.z + 1 < CHUNK_LENGTH && all_solid(
+                    { start.x, start.y, end.z + 1 },
+                    { end.x,   end.y,   end.z + 1 }
+                )) ++end.z;
+
+                while (end.y + 1 < CHUNK_LENGTH && all_solid(
+                    { start.x, end.y + 1, start.z },
+                    { end.x,   end.y + 1, end.z   }
+                )) ++end.y;
+
+                hvox::set_per_block_data(solid, start, end, false);
+
+                cuboids.emplace_back(ChunkColliderCuboid{ start, end });
+            }
+        }
+    }
+
+    delete[] solid;
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+btBoxShape* hphys::ChunkColliderCache<PrototypeEvaluator>::box_shape(ui32v3 extent) {
+    const ui32 key = (extent.x - 1) | ((extent.y - 1) << 8) | ((extent.z - 1) << 16);
+
+    auto& shape = m_box_shapes[key];
+    if (shape == nullptr) {
+        shape = std::make_unique<btBoxShape>(btVector3{
+            static_cast<btScalar>(extent.x) / 2.0f,
+            static_cast<btScalar>(extent.y) / 2.0f,
+            static_cast<btScalar>(extent.z) / 2.0f
+        });
+    }
+
+    return shape.get();
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkColliderCache<PrototypeEvaluator>::rebuild_body(
+    hmem::Handle<hvox::Chunk> chunk,
+                   ChunkBody& chunk_body
+) {
+    ChunkColliderCuboids cuboids;
+    {
+        std::shared_lock lock(chunk->blocks_mutex);
+
+        build_cuboids(*chunk, cuboids);
+    }
+
+    remove_body(chunk_body);
+
+    if (cuboids.empty()) return;
+
+    // The compound keeps its own tree over its boxes, so that
+    // only those near a contact are tested.
+    chunk_body.shape = new btCompoundShape(true, static_cast<int>(cuboids.size()));
+
+    for (auto& cuboid : cuboids) {
+        const ui32v3 extent = ui32v3{cuboid.end} - ui32v3{cuboid.start} + ui32v3{1};
+
+        btTransform transform = btTransform::getIdentity();
+        transform.setOrigin(btVector3{
+            static_cast<btScalar>(cuboid.start.x) + static_cast<btScalar>(extent.x) / 2.0f,
+            static_cast<btScalar>(cuboid.start.y) + static_cast<btScalar>(extent.y) / 2.0f,
+            static_cast<btScalar>(cuboid.start.z) + static_cast<btScalar>(extent.z) / 2.0f
+        });
+
+        chunk_body.shape->addChildShape(transform, box_shape(extent));
+    }
+
+    const hvox::BlockWorldPosition origin = hvox::block_world_position(chunk->position);
+
+    btRigidBody::btRigidBodyConstructionInfo body_info = btRigidBody::btRigidBodyConstructionInfo(0.0f, nullptr, chunk_body.shape);
+    body_info.m_startWorldTransform.setOrigin(btVector3{
+        static_cast<btScalar>(origin.x),
+        static_cast<btScalar>(origin.y),
+        static_cast<btScalar>(origin.z)
+    });
+    body_info.m_restitution = 0.0f;
+    body_info.m_friction    = m_friction;
+
+    chunk_body.body = new btRigidBody(body_info);
+
+    m_world->addRigidBody(chunk_body.body);
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkColliderCache<PrototypeEvaluator>::remove_body(ChunkBody& chunk_body) {
+    if (chunk_body.body != nullptr) {
+        m_world->removeRigidBody(chunk_body.body);
+
+        delete chunk_body.body;
+        chunk_body.body = nullptr;
+    }
+
+    delete chunk_body.shape;
+    chunk_body.shape = nullptr;
+}
@@ -61,55 +61,73 @@ bool hphys::ChunkGridCollider::determine_candidate_colliding_voxels(
         (static_cast<btScalar>(max_world_block_coord.z) - static_cast<btScalar>(min_world_block_coord.z)) / 2.0f
     };
 
-    auto new_chunk_coord = hvox::chunk_grid_position(
-        hvox::BlockWorldPosition{
-            min_world_block_coord.x,
-            min_world_block_coord.y,
-            min_world_block_coord.z
-        }
-    );
-    auto old_chunk_coord = new_chunk_coord;
-
     bool any_collidable = false;
 
-    auto chunk = chunk_grid->chunk(new_chunk_coord);
-    // TODO(Matthew): we don't want to fall through unloaded chunks.
-    if (chunk == nullptr)
-        return false;
+    // First block of the chunk after that holding the block at
+    // the given coordinate, along any one axis.
+    auto next_chunk_start = [](hvox::BlockWorldPositionCoord coord) {
+        const hvox::BlockWorldPositionCoord length = CHUNK_LENGTH;
 
-    std::shared_lock lock(chunk->blocks_mutex);
-    for (auto x = min_world_block_coord.x; x < max_world_block_coord.x; ++x) {
-        for (auto y = min_world_block_coord.y; y < max_world_block_coord.y; ++y) {
-            for (auto z = min_world_block_coord.z; z < max_world_block_coord.z; ++z) {
-                new_chunk_coord = hvox::chunk_grid_position({x,y,z});
+        return coord - ((coord % length) + length) % length + length;
+    };
 
-                if (old_chunk_coord != new_chunk_coord) {
-                    chunk           = chunk_grid->chunk(new_chunk_coord);
-                    lock            = std::shared_lock(chunk->blocks_mutex);
-                    old_chunk_coord = new_chunk_coord;
-                }
-                
-                auto block_idx = hvox::block_index(hvox::block_chunk_position({x,y,z}));
-                auto block     = chunk->blocks[block_idx];
-
-                btTransform transform = btTransform::getIdentity();
-                btCollisionShape* shape = shape_evaluator(block, transform);
-                if (shape) {
-                    // TODO(Matthew): In general, we need to make sure we are getting the
-                    //                coordinate systems of the colliding entity and the patch
-                    //                of the chunk grid voxels aligned correctly - at whichever
-                    //                point in the collision calculation process bullet wants
-                    //                that.
-                    //                    Probably here we want to just subtract the average
-                    //                    like so:
-                    transform.getOrigin() += btVector3{
-                        static_cast<btScalar>(x) - half_range.x() - static_cast<btScalar>(min_world_block_coord.x),
-                        static_cast<btScalar>(y) - half_range.y() - static_cast<btScalar>(min_world_block_coord.y),
-                        static_cast<btScalar>(z) - half_range.z() - static_cast<btScalar>(min_world_block_coord.z)
-                    };
-                    voxels->addChildShape(transform, shape);
-
-                    any_collidable = true;
+    /*
+     * The patch is gathered chunk by chunk, such that each chunk
+     * is looked up and locked just the once, and those parts of
+     * chunks holding only air, which is taken to have no shape,
+     * are passed over in a single test of the chunk's occupancy
+     * pyramid.
+     */
+    for (auto chunk_x = min_world_block_coord.x; chunk_x < max_world_block_coord.x; chunk_x = next_chunk_start(chunk_x)) {
+        for (auto chunk_y = min_world_block_coord.y; chunk_y < max_world_block_coord.y; chunk_y = next_chunk_start(chunk_y)) {
+            for (auto chunk_z = min_world_block_coord.z; chunk_z < max_world_block_coord.z; chunk_z = next_chunk_start(chunk_z)) {
+                const hvox::BlockWorldPosition start = { chunk_x, chunk_y, chunk_z };
+                const hvox::BlockWorldPosition end   = {
+                    std::min(next_chunk_start(chunk_x), max_world_block_coord.x),
+                    std::min(next_chunk_start(chunk_y), max_world_block_coord.y),
+                    std::min(next_chunk_start(chunk_z), max_world_block_coord.z)
+                };
+
+                auto chunk = chunk_grid->chunk(hvox::chunk_grid_position(start));
+                // TODO(Matthew): we don't want to fall through unloaded chunks.
+                if (chunk == nullptr) continue;
+
+                std::shared_lock lock(chunk->blocks_mutex);
+
+                if (!chunk->blocks.occupancy().any_solid(
+                    hvox::block_chunk_position(start),
+                    hvox::block_chunk_position(end - 1)
+                )) continue;
+
+                for (auto x = start.x; x < end.x; ++x) {
+                    for (auto y = start.y; y < end.y; ++y) {
+                        for (auto z = start.z; z < end.z; ++z) {
+                            auto block_idx = hvox::block_index(hvox::block_chunk_position({x,y,z}));
+                            auto block     = chunk->blocks[block_idx];
+
+                            if (block == hvox::NULL_BLOCK) continue;
+
+                            btTransform transform = btTransform::getIdentity();
+                            btCollisionShape* shape = shape_evaluator(block, transform);
+                            if (shape) {
+                                // TODO(Matthew): In general, we need to make sure we are getting the
+                                //                coordinate systems of the colliding entity and the patch
+                                //                of the chunk grid voxels aligned correctly - at whichever
+                                //                point in the collision calculation process bullet wants
+                                //                that.
+                                //                    Probably here we want to just subtract the average
+                                //                    like so:
+                                transform.getOrigin() += btVector3{
+                                    static_cast<btScalar>(x) - half_range.x() - static_cast<btScalar>(min_world_block_coord.x),
+                                    static_cast<btScalar>(y) - half_range.y() - static_cast<btScalar>(min_world_block_coord.y),
+                                    static_cast<btScalar>(z) - half_range.z() - static_cast<btScalar>(min_world_block_coord.z)
+                                };
+                                voxels->addChildShape(transform, shape);
+
+                                any_collidable = true;
+                            }
+                        }
+                    }
                 }
             }
         }
@@ -0,0 +1,139 @@
+#ifndef __hemlock_physics_voxel_chunk_grid_shape_hpp
+#define __hemlock_physics_voxel_chunk_grid_shape_hpp
+
+#include <bullet/BulletCollision/CollisionShapes/btConcaveShape.h>
+#include <bullet/BulletCollision/CollisionShapes/btTriangleCallback.h>
+
+#include "memory/handle.hpp"
+#include "voxel/block.hpp"
+#include "voxel/coordinate_system.h"
+
+namespace hemlock {
+    namespace voxel {
+        class ChunkGrid;
+    }
+
+    namespace physics {
+        /**
+         * @brief The collision geometry of a kind of block, shared
+         * by all blocks of that kind.
+         *
+         * Triangles are given by their vertices in threes, in the
+         * space of the block, which spans [0, 1] along each axis.
+         */
+        struct VoxelShapePrototype {
+            // Triangles lying on each face of the block, in the
+            // order left, right, bottom, top, front then back as
+            // with BlockFace. These are left out where the block
+            // neighbouring that face fills its own block.
+            std::vector<btVector3> face_triangles[6];
+            // Triangles not lying on any face of the block.
+            std::vector<btVector3> inner_triangles;
+            // Whether the shape fills its block, hiding the faces
+            // of neighbouring blocks against it.
+            bool fills_block = false;
+
+            /**
+             * @brief The prototype of a block filled by a cube.
+             */
+            static const VoxelShapePrototype& unit_cube();
+        };
+
+        /**
+         * @brief Defines a struct whose operator() determines the
+         * shape prototype of a block.
+         *
+         * The function returns a pointer to the prototype shared by
+         * blocks of that kind if the block can be collided with,
+         * otherwise nullptr.
+         */
+        template <typename EvaluatorCandidate>
+        concept VoxelPrototypeEvaluator = requires (
+            EvaluatorCandidate e,
+                   hvox::Block b
+        ) {
+            { e.operator()(b) } -> std::same_as<const VoxelShapePrototype*>;
+        };
+
+        /**
+         * @brief A static collision shape made up of the blocks of a
+         * chunk grid, read from the grid as Bullet asks for them.
+         *
+         * Bullet collides a concave shape by asking it for its
+         * triangles overlapping the bounds of whichever body may be
+         * in contact with it, and so the cost of collision with the
+         * grid goes with the area in contact, with no shapes built
+         * for blocks ahead of time. The triangles of each block come
+         * from the prototype of its kind, with faces against blocks
+         * filling their own block left out.
+         *
+         * The space of the shape is that of blocks, offset by an
+         * origin block such that coordinates stay small near it.
+         *
+         * NOTE: chunks are looked up through the chunk grid, and so
+         * the physics world holding this shape must be stepped on the
+         * thread owning the grid, or while that thread waits on it.
+         */
+        template <VoxelPrototypeEvaluator PrototypeEvaluator>
+        class ChunkGridShape : public btConcaveShape {
+        public:
+            // Queries spanning more blocks than this produce no
+            // triangles, as is the case for debug drawing and long
+            // rays, which should instead be cast with hvox::Ray.
+            static constexpr i64 MAX_QUERY_BLOCKS = 64 * 64 * 64;
+
+            /**
+             * @param chunk_grid The chunk grid the shape is made of.
+             * @param origin The block at the origin of the shape's space.
+             * @param half_extent The half-extent in blocks of the bounds
+             * given to the broadphase, centred on the origin.
+             */
+            ChunkGridShape(
+                hmem::WeakHandle<hvox::ChunkGrid> chunk_grid,
+                         hvox::BlockWorldPosition origin      = hvox::BlockWorldPosition{0},
+                                         btScalar half_extent = static_cast<btScalar>(1 << 16)
+            );
+            virtual ~ChunkGridShape() { /* Empty. */ }
+
+            /**
+             * @brief Sets the block at the origin of the shape's space.
+             * Any body holding the shape should be moved along with it.
+             *
+             * @param origin The block at the origin of the shape's space.
+             */
+            void set_origin(hvox::BlockWorldPosition origin) { m_origin = origin; }
+            hvox::BlockWorldPosition origin() const { return m_origin; }
+
+            virtual void processAllTriangles(
+                btTriangleCallback* callback,
+                  const btVector3&  aabb_min,
+                  const btVector3&  aabb_max
+            ) const override;
+
+            virtual void getAabb(const btTransform& transform, btVector3& aabb_min, btVector3& aabb_max) const override;
+
+            virtual void setLocalScaling(const btVector3& scaling) override { m_local_scaling = scaling; }
+            virtual const btVector3& getLocalScaling() const override { return m_local_scaling; }
+
+            /**
+             * @brief The shape is only meant for static bodies, and so
+             * has no inertia.
+             */
+            virtual void calculateLocalInertia(btScalar, btVector3& inertia) const override {
+                inertia.setValue(0.0f, 0.0f, 0.0f);
+            }
+
+            virtual const char* getName() const override { return "ChunkGridShape"; }
+        protected:
+            hmem::WeakHandle<hvox::ChunkGrid>   m_chunk_grid;
+            hvox::BlockWorldPosition            m_origin;
+            btScalar                            m_half_extent;
+            btVector3                           m_local_scaling;
+        };
+    }
+}
+namespace hphys = hemlock::physics;
+
+#include "chunk_grid_shape.inl"
+
+#endif // __hemlock_physics_voxel_chunk_grid_shape_hpp
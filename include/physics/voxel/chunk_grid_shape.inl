@@ -0,0 +1,214 @@
+#include <bullet/LinearMath/btAabbUtil2.h>
+
+#include "voxel/chunk/grid.h"
+
+inline const hphys::VoxelShapePrototype& hphys::VoxelShapePrototype::unit_cube() {
+    static const VoxelShapePrototype cube = []() {
+        VoxelShapePrototype prototype;
+
+        // Adds the two triangles of the quad a, b, c, d, given
+        // anticlockwise as seen from outside the cube.
+        auto add_quad = [](std::vector<btVector3>& triangles, btVector3 a, btVector3 b, btVector3 c, btVector3 d) {
+            triangles.insert(triangles.end(), { a, b, c, a, c, d });
+        };
+
+        add_quad(prototype.face_triangles[0], { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, { 0, 1, 0 }); // LEFT
+        add_quad(prototype.face_triangles[1], { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 1 }, { 1, 0, 1 }); // RIGHT
+        add_quad(prototype.face_triangles[2], { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 }, { 0, 0, 1 }); // BOTTOM
+        add_quad(prototype.face_triangles[3], { 0, 1, 0 }, { 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }); // TOP
+        add_quad(prototype.face_triangles[4], { 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 }); // FRONT
+        add_quad(prototype.face_triangles[5], { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }); // BACK
+
+        prototype.fills_block = true;
+
+        return prototype;
+    }();
+
+    return cube;
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+hphys::ChunkGridShape<PrototypeEvaluator>::ChunkGridShape(
+    hmem::WeakHandle<hvox::ChunkGrid> chunk_grid,
+             hvox::BlockWorldPosition origin      /*= hvox::BlockWorldPosition{0}*/,
+                             btScalar half_extent /*= static_cast<btScalar>(1 << 16)*/
+) :
+    btConcaveShape(),
+    m_chunk_grid(chunk_grid),
+    m_origin(origin),
+    m_half_extent(half_extent),
+    m_local_scaling(1.0f, 1.0f, 1.0f)
+{
+    m_shapeType = CUSTOM_CONCAVE_SHAPE_TYPE;
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkGridShape<PrototypeEvaluator>::processAllTriangles(
+    btTriangleCallback* callback,
+      const btVector3&  aabb_min,
+      const btVector3&  aabb_max
+) const {
+    // Offset from one block to its neighbour across each face,
+    // in the order of VoxelShapePrototype::face_triangles.
+    static constexpr i32 FACE_OFFSET[6][3] = {
+        { -1,  0,  0 }, { 1, 0, 0 },
+        {  0, -1,  0 }, { 0, 1, 0 },
+        {  0,  0, -1 }, { 0, 0, 1 }
+    };
+
+    auto chunk_grid = m_chunk_grid.lock();
+    if (chunk_grid == nullptr) return;
+
+    const PrototypeEvaluator prototype_of = {};
+
+    /*
+     * Find the blocks overlapping the bounds queried, clamping
+     * the bounds first so that those of infinite extent do not
+     * overflow block coordinates.
+     */
+    const btScalar limit = static_cast<btScalar>(1 << 30);
+
+    hvox::BlockWorldPosition start, end;
+    for (int axis = 0; axis < 3; ++axis) {
+        const btScalar lower = btClamped(aabb_min[axis] / m_local_scaling[axis], -limit, limit);
+        const btScalar upper = btClamped(aabb_max[axis] / m_local_scaling[axis], -limit, limit);
+
+        start[axis] = static_cast<hvox::BlockWorldPositionCoord>(std::floor(std::min(lower, upper))) + m_origin[axis];
+        end[axis]   = static_cast<hvox::BlockWorldPositionCoord>(std::floor(std::max(lower, upper))) + m_origin[axis];
+    }
+
+    const i64 query_blocks = static_cast<i64>(end.x - start.x + 1)
+                                * static_cast<i64>(end.y - start.y + 1)
+                                * static_cast<i64>(end.z - start.z + 1);
+    if (query_blocks > MAX_QUERY_BLOCKS) return;
+
+    // First block of the chunk after that holding the block at
+    // the given coordinate, along any one axis.
+    auto next_chunk_start = [](hvox::BlockWorldPositionCoord coord) {
+        const hvox::BlockWorldPositionCoord length = CHUNK_LENGTH;
+
+        return coord - ((coord % length) + length) % length + length;
+    };
+
+    btVector3 triangle[3];
+
+    for (auto chunk_z = start.z; chunk_z <= end.z; chunk_z = next_chunk_start(chunk_z)) {
+        for (auto chunk_y = start.y; chunk_y <= end.y; chunk_y = next_chunk_start(chunk_y)) {
+            for (auto chunk_x = start.x; chunk_x <= end.x; chunk_x = next_chunk_start(chunk_x)) {
+                const hvox::BlockWorldPosition chunk_start = { chunk_x, chunk_y, chunk_z };
+                const hvox::BlockWorldPosition chunk_end   = {
+                    std::min(next_chunk_start(chunk_x) - 1, end.x),
+                    std::min(next_chunk_start(chunk_y) - 1, end.y),
+                    std::min(next_chunk_start(chunk_z) - 1, end.z)
+                };
+
+                auto chunk = chunk_grid->chunk(hvox::chunk_grid_position(chunk_start));
+                if (chunk == nullptr) continue;
+
+                // Neighbours are looked up once for the chunk rather than
+                // for each block on its faces, in the same order as
+                // FACE_OFFSET. Any not loaded hide no faces.
+                hmem::Handle<hvox::Chunk> neighbours[6];
+                for (size_t face = 0; face < 6; ++face) {
+                    neighbours[face] = chunk_grid->chunk(hvox::chunk_grid_position(hvox::BlockWorldPosition{
+                        chunk_x + FACE_OFFSET[face][0] * CHUNK_LENGTH,
+                        chunk_y + FACE_OFFSET[face][1] * CHUNK_LENGTH,
+                        chunk_z + FACE_OFFSET[face][2] * CHUNK_LENGTH
+                    }));
+                }
+
+                std::shared_lock lock(chunk->blocks_mutex);
+
+                if (!chunk->blocks.occupancy().any_solid(
+                    hvox::block_chunk_position(chunk_start),
+                    hvox::block_chunk_position(chunk_end)
+                )) continue;
+
+                for (auto z = chunk_start.z; z <= chunk_end.z; ++z) {
+                    for (auto y = chunk_start.y; y <= chunk_end.y; ++y) {
+                        for (auto x = chunk_start.x; x <= chunk_end.x; ++x) {
+                            const hvox::BlockChunkPosition local = hvox::block_chunk_position({ x, y, z });
+                            const hvox::BlockIndex         index = hvox::block_index(local);
+
+                            const hvox::Block block = chunk->blocks[index];
+                            if (block == hvox::NULL_BLOCK) continue;
+
+                            const VoxelShapePrototype* prototype = prototype_of(block);
+                            if (prototype == nullptr) continue;
+
+                            const btVector3 corner = btVector3{
+                                static_cast<btScalar>(x - m_origin.x),
+                                static_cast<btScalar>(y - m_origin.y),
+                                static_cast<btScalar>(z - m_origin.z)
+                            };
+
+                            int triangle_index = 0;
+                            auto emit_triangles = [&](const std::vector<btVector3>& vertices) {
+                                for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+                                    for (size_t j = 0; j < 3; ++j) {
+                                        triangle[j] = (corner + vertices[i + j]) * m_local_scaling;
+                                    }
+
+                                    callback->processTriangle(triangle, static_cast<int>(index), triangle_index++);
+                                }
+                            };
+
+                            for (size_t face = 0; face < 6; ++face) {
+                                if (prototype->face_triangles[face].empty()) continue;
+
+                                const i32 neighbour_x = static_cast<i32>(local.x) + FACE_OFFSET[face][0];
+                                const i32 neighbour_y = static_cast<i32>(local.y) + FACE_OFFSET[face][1];
+                                const i32 neighbour_z = static_cast<i32>(local.z) + FACE_OFFSET[face][2];
+
+                                // The neighbouring block, wrapped into the chunk
+                                // holding it, whether this or its neighbour.
+                                const hvox::BlockIndex neighbour_index = hvox::block_index({
+                                    static_cast<ui8>((neighbour_x + CHUNK_LENGTH) % CHUNK_LENGTH),
+                                    static_cast<ui8>((neighbour_y + CHUNK_LENGTH) % CHUNK_LENGTH),
+                                    static_cast<ui8>((neighbour_z + CHUNK_LENGTH) % CHUNK_LENGTH)
+                                });
+
+                                hvox::Block neighbour = hvox::NULL_BLOCK;
+                                if (
+                                    static_cast<ui32>(neighbour_x) < CHUNK_LENGTH
+                                        && static_cast<ui32>(neighbour_y) < CHUNK_LENGTH
+                                        && static_cast<ui32>(neighbour_z) < CHUNK_LENGTH
+                                ) {
+                                    neighbour = chunk->blocks[neighbour_index];
+                                } else if (neighbours[face] != nullptr) {
+                                    std::shared_lock neighbour_lock(neighbours[face]->blocks_mutex);
+
+                                    neighbour = neighbours[face]->blocks[neighbour_index];
+                                }
+
+                                if (neighbour != hvox::NULL_BLOCK) {
+                                    const VoxelShapePrototype* neighbour_prototype = prototype_of(neighbour);
+                                    if (neighbour_prototype != nullptr && neighbour_prototype->fills_block) continue;
+                                }
+
+                                emit_triangles(prototype->face_triangles[face]);
+                            }
+
+                            emit_triangles(prototype->inner_triangles);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <hphys::VoxelPrototypeEvaluator PrototypeEvaluator>
+void hphys::ChunkGridShape<PrototypeEvaluator>::getAabb(
+    const btTransform& transform,
+            btVector3& aabb_min,
+            btVector3& aabb_max
+) const {
+    btTransformAabb(
+        btVector3(m_half_extent, m_half_extent, m_half_extent) * m_local_scaling,
+        getMargin(),
+        transform,
+        aabb_min,
+        aabb_max
+    );
+}
@@ -0,0 +1,82 @@
+#ifndef __hemlock_physics_world_h
+#define __hemlock_physics_world_h
+
+#include <bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+
+#include "timing.h"
+#include "physics/task_scheduler.h"
+
+namespace hemlock {
+    namespace physics {
+        /**
+         * @brief A multithreaded Bullet world, stepped across a
+         * thread pool of its own.
+         *
+         * Narrowphase collision of the pairs found by the broadphase
+         * and solving of islands of bodies in contact are spread over
+         * the scheduler's threads and the thread stepping the world.
+         *
+         * NOTE: Bullet's task scheduler is global, so only one world
+         * should be initialised at any one time.
+         */
+        class PhysicsWorld {
+        public:
+            PhysicsWorld();
+            ~PhysicsWorld() { /* Empty. */ }
+
+            /**
+             * @brief Initialises the world, starting the threads its
+             * steps are run across.
+             *
+             * @param thread_count The number of threads to step the
+             * world across besides the thread stepping it. These are
+             * best taken from those not used for chunk tasks, so as
+             * not to oversubscribe the cores.
+             * @param fixed_time_step The length of each substep, in
+             * seconds.
+             * @param max_sub_steps The most substeps taken in one step
+             * before time is dropped.
+             */
+            void init(     ui32 thread_count,
+                       btScalar fixed_time_step = 1.0f / 60.0f,
+                           ui32 max_sub_steps   = 4 );
+            /**
+             * @brief Disposes of the world, along with its threads.
+             * Any bodies still in the world are not deleted.
+             */
+            void dispose();
+
+            /**
+             * @brief Steps the world forward by the time taken by
+             * the frame, in as many fixed substeps as that time
+             * covers.
+             *
+             * @param time The time data for the frame.
+             */
+            void step(FrameTime time);
+
+            btDiscreteDynamicsWorldMt* world() { return m_world; }
+            const btDiscreteDynamicsWorldMt* world() const { return m_world; }
+
+            btDiscreteDynamicsWorldMt* operator->() { return m_world; }
+            const btDiscreteDynamicsWorldMt* operator->() const { return m_world; }
+        protected:
+            ThreadPoolTaskScheduler             m_task_scheduler;
+
+            btDbvtBroadphase*                   m_broadphase;
+            btDefaultCollisionConfiguration*    m_collision_config;
+            btCollisionDispatcherMt*            m_dispatcher;
+            btConstraintSolverPoolMt*           m_solver_pool;
+            btDiscreteDynamicsWorldMt*          m_world;
+
+            btScalar    m_fixed_time_step;
+            ui32        m_max_sub_steps;
+        };
+    }
+}
+namespace hphys = hemlock::physics;
+
+#endif // __hemlock_physics_world_h
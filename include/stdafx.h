@@ -6,6 +6,7 @@
 
 // Containers
 #include <boost/circular_buffer.hpp>
+#include <list>
 #include <map>
 #include <moodycamel/blockingconcurrentqueue.h>
 #include <moodycamel/concurrentqueue.h>
@@ -28,6 +29,7 @@
 
 // Generics
 #include <algorithm>
+#include <bit>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -35,6 +37,7 @@
 #include <utility>
 
 // Thread Handling
+#include <condition_variable>
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
@@ -27,6 +27,106 @@ namespace hemlock {
         template <InterruptibleState ThreadState>
         using TaskQueue = moodycamel::BlockingConcurrentQueue<HeldTask<ThreadState>>;
 
+        /**
+         * @brief How a thread pool orders the tasks added to it.
+         *
+         * FIFO runs tasks in the order they were added, PRIORITY
+         * runs the task of lowest priority value first, and tasks
+         * of equal priority in the order they were added.
+         */
+        enum class ThreadPoolScheduling : ui8 {
+            FIFO,
+            PRIORITY
+        };
+
+        /**
+         * @brief Queue of tasks ordered by their priority, the
+         * task of lowest priority value being dequeued first.
+         *
+         * Unlike TaskQueue this is guarded by a mutex, which
+         * allows the priorities of all queued tasks to be changed
+         * at once.
+         */
+        template <InterruptibleState ThreadState>
+        class PriorityTaskQueue {
+        public:
+            PriorityTaskQueue() :
+                m_next_sequence(0)
+            { /* Empty. */ }
+            ~PriorityTaskQueue() { /* Empty. */ }
+
+            /**
+             * @brief Adds a task to the queue.
+             *
+             * @param task The task to add.
+             */
+            void enqueue(HeldTask<ThreadState> task);
+            /**
+             * @brief Adds a set of tasks to the queue.
+             *
+             * @param tasks The tasks to add.
+             * @param task_count The number of tasks to add.
+             */
+            void enqueue_bulk(HeldTask<ThreadState> tasks[], size_t task_count);
+
+            /**
+             * @brief Takes the task of lowest priority value from
+             * the queue, waiting for one to be added if the queue
+             * is empty, or until woken with the given predicate
+             * returning true.
+             *
+             * @param task Set to the task taken.
+             * @param wake Checked under the queue's lock each time
+             * the waiting thread is woken, returning true if the
+             * thread should stop waiting without a task.
+             * @return True if a task was taken, false otherwise.
+             */
+            template <typename WakePredicate>
+                requires std::is_invocable_r_v<bool, WakePredicate>
+            bool wait_dequeue(OUT HeldTask<ThreadState>& task, WakePredicate wake);
+
+            /**
+             * @brief Wakes all threads waiting on the queue, such
+             * that they check their wake predicates anew.
+             */
+            void notify_all();
+
+            /**
+             * @brief Recomputes the priority of every queued task.
+             *
+             * @param prioritiser Called with each queued task,
+             * returning its new priority.
+             */
+            template <typename Prioritiser>
+                requires std::is_invocable_r_v<ui32, Prioritiser, IThreadTask<ThreadState>*>
+            void reprioritise(Prioritiser prioritiser);
+
+            /**
+             * @brief Drops all queued tasks, disposing of each and
+             * deleting those the queue is to delete.
+             */
+            void clear();
+
+            /**
+             * @brief The number of tasks queued.
+             */
+            size_t size();
+        protected:
+            struct Entry {
+                HeldTask<ThreadState>   held;
+                ui64                    sequence;
+            };
+
+            // Orders the heap such that its front is the task of
+            // lowest priority, and then of earliest sequence.
+            static bool runs_after(const Entry& lhs, const Entry& rhs);
+
+            std::mutex              m_mutex;
+            std::condition_variable m_condition;
+            std::vector<Entry>      m_heap;
+            ui64                    m_next_sequence;
+        };
+
         template <InterruptibleState ThreadState>
         struct Thread {
             std::thread thread;
@@ -34,6 +134,10 @@ namespace hemlock {
                 ThreadState context = {};
                 moodycamel::ConsumerToken consumer_token;
                 moodycamel::ProducerToken producer_token;
+                // Set only if the owning thread pool uses priority
+                // scheduling, in which case tasks added to the pool
+                // are queued here rather than in the task queue.
+                PriorityTaskQueue<ThreadState>* priority_tasks = nullptr;
             } state;
         };
         template <InterruptibleState ThreadState>
@@ -51,6 +155,16 @@ namespace hemlock {
              */
             virtual void dispose() { /* Empty */ }
 
+            /**
+             * @brief Whether the task has been cancelled, checked
+             * when the task is dequeued such that cancelled tasks
+             * are dropped without being executed. Long-running tasks
+             * may also check this as they go to end early.
+             *
+             * @return True if the task is cancelled, false otherwise.
+             */
+            virtual bool is_cancelled() { return false; }
+
             /**
              * @brief Executes the task, this must be implemented
              * by inheriting tasks.
@@ -67,6 +181,14 @@ namespace hemlock {
              * @brief Tracks completion state of the task.
              */
             volatile bool is_finished = false;
+
+            /**
+             * @brief The priority of the task on a thread pool using
+             * priority scheduling, tasks of lower value being run
+             * first. Once the task is added to a thread pool, this
+             * should only be changed through reprioritise.
+             */
+            ui32 priority = 0;
         };
 
         template <InterruptibleState ThreadState>
@@ -77,7 +199,14 @@ namespace hemlock {
 
         /**
          * @brief A basic main function of threads.
-         * 
+         *
+         * If the thread pool uses priority scheduling, tasks
+         * chained onto the task queue by running tasks are taken
+         * before any in the priority queue, as they continue work
+         * already begun. Threads waiting on the priority queue
+         * are woken by whichever thread ran the task that chained
+         * more onto the task queue.
+         *
          * @param state The thread state, including tokens for
          * interacting with task queue, and thread pool specific
          * context.
@@ -92,6 +221,7 @@ namespace hemlock {
         public:
             ThreadPool() :
                 m_is_initialised(false),
+                m_scheduling(ThreadPoolScheduling::FIFO),
                 m_producer_token(moodycamel::ProducerToken(m_tasks))
             { /* Empty. */ }
             ~ThreadPool() { /* Empty. */ }
@@ -102,8 +232,12 @@ namespace hemlock {
              *
              * @param thread_count The number of threads the pool shall
              * possess.
+             * @param thread_main_func The main function of each thread.
+             * @param scheduling How tasks added to the pool are ordered.
              */
-            void init(ui32 thread_count, ThreadMainFunc<ThreadState> thread_main_func = ThreadMainFunc<ThreadState>{basic_thread_main<ThreadState>});
+            void init(                   ui32 thread_count,
+                       ThreadMainFunc<ThreadState> thread_main_func = ThreadMainFunc<ThreadState>{basic_thread_main<ThreadState>},
+                             ThreadPoolScheduling scheduling       = ThreadPoolScheduling::FIFO );
             /**
              * @brief Cleans up the thread pool, bringing all threads
              * to a stop.
@@ -163,6 +297,21 @@ namespace hemlock {
              */
             void threadsafe_add_tasks(HeldTask<ThreadState> tasks[], size_t task_count);
 
+            /**
+             * @brief Recomputes the priority of every task waiting
+             * to be run, for example as the focus of the work being
+             * done moves. Does nothing unless the thread pool uses
+             * priority scheduling.
+             *
+             * NOTE: This can be called from any thread.
+             *
+             * @param prioritiser Called with each waiting task,
+             * returning its new priority.
+             */
+            template <typename Prioritiser>
+                requires std::is_invocable_r_v<ui32, Prioritiser, IThreadTask<ThreadState>*>
+            void reprioritise(Prioritiser prioritiser);
+
             /**
              * @brief The number of threads held by the thread pool.
              */
@@ -175,6 +324,9 @@ namespace hemlock {
 
             bool m_is_initialised;
 
+            ThreadPoolScheduling            m_scheduling;
+            PriorityTaskQueue<ThreadState>  m_priority_tasks;
+
             ThreadMainFunc<ThreadState> m_thread_main_func;
             Threads<ThreadState>        m_threads;
             TaskQueue<ThreadState>      m_tasks;
@@ -16,11 +16,27 @@ void hthread::basic_thread_main( typename Thread<ThreadState>::State* state,
 
     HeldTask<ThreadState> held = {nullptr, false};
     while (!state->context.stop) {
-        task_queue->wait_dequeue_timed(
-            state->consumer_token,
-            held,
-            std::chrono::seconds(1)
-        );
+        if (state->priority_tasks) {
+            // NOTE(Matthew): tasks chained onto the task queue can't
+            //                wake threads waiting on the priority queue
+            //                themselves, so threads notify the priority
+            //                queue after running a task that chained any,
+            //                and on waking check the task queue anew.
+            if (!task_queue->try_dequeue(state->consumer_token, held)) {
+                state->priority_tasks->wait_dequeue(
+                    held,
+                    [&]() {
+                        return state->context.stop || task_queue->size_approx() > 0;
+                    }
+                );
+            }
+        } else {
+            task_queue->wait_dequeue_timed(
+                state->consumer_token,
+                held,
+                std::chrono::seconds(1)
+            );
+        }
 
         while (state->context.suspend)
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -30,41 +46,149 @@ void hthread::basic_thread_main( typename Thread<ThreadState>::State* state,
             continue;
         }
 
-        held.task->execute(state, task_queue);
+        if (!held.task->is_cancelled())
+            held.task->execute(state, task_queue);
         held.task->is_finished = true;
         held.task->dispose();
         if (held.should_delete) delete held.task;
         held.task = nullptr;
+
+        if (state->priority_tasks && task_queue->size_approx() > 0)
+            state->priority_tasks->notify_all();
     }
 }
 
+template <hthread::InterruptibleState ThreadState>
+void hthread::PriorityTaskQueue<ThreadState>::enqueue(HeldTask<ThreadState> task) {
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_heap.emplace_back(Entry{ task, m_next_sequence++ });
+        std::push_heap(m_heap.begin(), m_heap.end(), runs_after);
+    }
+
+    m_condition.notify_one();
+}
+
+template <hthread::InterruptibleState ThreadState>
+void hthread::PriorityTaskQueue<ThreadState>::enqueue_bulk(HeldTask<ThreadState> tasks[], size_t task_count) {
+    {
+        std::lock_guard lock(m_mutex);
+
+        for (size_t i = 0; i < task_count; ++i) {
+            m_heap.emplace_back(Entry{ tasks[i], m_next_sequence++ });
+            std::push_heap(m_heap.begin(), m_heap.end(), runs_after);
+        }
+    }
+
+    m_condition.notify_all();
+}
+
+template <hthread::InterruptibleState ThreadState>
+template <typename WakePredicate>
+    requires std::is_invocable_r_v<bool, WakePredicate>
+bool hthread::PriorityTaskQueue<ThreadState>::wait_dequeue(OUT HeldTask<ThreadState>& task, WakePredicate wake) {
+    std::unique_lock lock(m_mutex);
+
+    m_condition.wait(lock, [&]() { return !m_heap.empty() || wake(); });
+
+    if (m_heap.empty()) return false;
+
+    std::pop_heap(m_heap.begin(), m_heap.end(), runs_after);
+    task = m_heap.back().held;
+    m_heap.pop_back();
+
+    return true;
+}
+
+template <hthread::InterruptibleState ThreadState>
+void hthread::PriorityTaskQueue<ThreadState>::notify_all() {
+    // Taking the lock ensures no thread is between checking its
+    // wake predicate and beginning to wait, so none miss this.
+    {
+        std::lock_guard lock(m_mutex);
+    }
+
+    m_condition.notify_all();
+}
+
+template <hthread::InterruptibleState ThreadState>
+template <typename Prioritiser>
+    requires std::is_invocable_r_v<ui32, Prioritiser, hthread::IThreadTask<ThreadState>*>
+void hthread::PriorityTaskQueue<ThreadState>::reprioritise(Prioritiser prioritiser) {
+    std::lock_guard lock(m_mutex);
+
+    for (auto& entry : m_heap) {
+        entry.held.task->priority = prioritiser(entry.held.task);
+    }
+
+    std::make_heap(m_heap.begin(), m_heap.end(), runs_after);
+}
+
+template <hthread::InterruptibleState ThreadState>
+void hthread::PriorityTaskQueue<ThreadState>::clear() {
+    std::lock_guard lock(m_mutex);
+
+    // Tasks are dropped as they would be once run, so that those
+    // held by the queue are not leaked.
+    for (auto& entry : m_heap) {
+        entry.held.task->dispose();
+        if (entry.held.should_delete) delete entry.held.task;
+    }
+
+    std::vector<Entry>().swap(m_heap);
+}
+
+template <hthread::InterruptibleState ThreadState>
+size_t hthread::PriorityTaskQueue<ThreadState>::size() {
+    std::lock_guard lock(m_mutex);
+
+    return m_heap.size();
+}
+
+template <hthread::InterruptibleState ThreadState>
+bool hthread::PriorityTaskQueue<ThreadState>::runs_after(const Entry& lhs, const Entry& rhs) {
+    if (lhs.held.task->priority != rhs.held.task->priority)
+        return lhs.held.task->priority > rhs.held.task->priority;
+
+    return lhs.sequence > rhs.sequence;
+}
+
 template <hthread::InterruptibleState ThreadState>
 void hthread::ThreadPool<ThreadState>::init(           ui32 thread_count,
-                                ThreadMainFunc<ThreadState> thread_main_func /*= {basic_thread_main}*/  )
+                                ThreadMainFunc<ThreadState> thread_main_func /*= {basic_thread_main}*/,
+                                       ThreadPoolScheduling scheduling       /*= ThreadPoolScheduling::FIFO*/  )
 {
     if (m_is_initialised) return;
     m_is_initialised = true;
 
     m_thread_main_func = thread_main_func;
+    m_scheduling       = scheduling;
+
+    PriorityTaskQueue<ThreadState>* priority_tasks = nullptr;
+    if (m_scheduling == ThreadPoolScheduling::PRIORITY) priority_tasks = &m_priority_tasks;
 
     m_producer_token = moodycamel::ProducerToken(m_tasks);
 
+    // NOTE(Matthew): the state of every thread is put in place
+    //                before any thread is started, as otherwise a
+    //                thread may read its state before it has been
+    //                moved into m_threads.
     m_threads.reserve(thread_count);
     for (ui32 i = 0; i < thread_count; ++i) {
         m_threads.emplace_back(Thread<ThreadState>{
-            .thread = std::thread(
-                m_thread_main_func,
-                reinterpret_cast<typename Thread<ThreadState>::State*>(
-                    reinterpret_cast<ui8*>(&m_threads.data()[i]) + offsetof(Thread<ThreadState>, state)
-                ),
-                &m_tasks
-            ),
+            .thread = std::thread(),
             .state {
                 .consumer_token = moodycamel::ConsumerToken(m_tasks),
-                .producer_token = moodycamel::ProducerToken(m_tasks)
+                .producer_token = moodycamel::ProducerToken(m_tasks),
+                .priority_tasks = priority_tasks
             }
         });
     }
+
+    for (auto& thread : m_threads) {
+        thread.thread = std::thread(m_thread_main_func, &thread.state, &m_tasks);
+    }
 }
 
 template <hthread::InterruptibleState ThreadState>
@@ -79,10 +203,15 @@ void hthread::ThreadPool<ThreadState>::dispose() {
         thread.state.context.suspend = false;
     }
 
+    // Threads waiting on the priority queue only wake when
+    // notified.
+    if (m_scheduling == ThreadPoolScheduling::PRIORITY) m_priority_tasks.notify_all();
+
     for (auto& thread : m_threads)
         thread.thread.join();
 
     TaskQueue<ThreadState>().swap(m_tasks);
+    m_priority_tasks.clear();
 
     Threads<ThreadState>().swap(m_threads);
 }
@@ -101,20 +230,49 @@ void hthread::ThreadPool<ThreadState>::resume() {
 
 template <hthread::InterruptibleState ThreadState>
 void hthread::ThreadPool<ThreadState>::add_task(HeldTask<ThreadState> task) {
+    if (m_scheduling == ThreadPoolScheduling::PRIORITY) {
+        m_priority_tasks.enqueue(task);
+        return;
+    }
+
     m_tasks.enqueue(m_producer_token, task);
 }
 
 template <hthread::InterruptibleState ThreadState>
 void hthread::ThreadPool<ThreadState>::add_tasks(HeldTask<ThreadState> tasks[], size_t task_count) {
+    if (m_scheduling == ThreadPoolScheduling::PRIORITY) {
+        m_priority_tasks.enqueue_bulk(tasks, task_count);
+        return;
+    }
+
     m_tasks.enqueue_bulk(m_producer_token, tasks, task_count);
 }
 
 template <hthread::InterruptibleState ThreadState>
 void hthread::ThreadPool<ThreadState>::threadsafe_add_task(HeldTask<ThreadState> task) {
+    if (m_scheduling == ThreadPoolScheduling::PRIORITY) {
+        m_priority_tasks.enqueue(task);
+        return;
+    }
+
     m_tasks.enqueue(task);
 }
 
 template <hthread::InterruptibleState ThreadState>
 void hthread::ThreadPool<ThreadState>::threadsafe_add_tasks(HeldTask<ThreadState> tasks[], size_t task_count) {
+    if (m_scheduling == ThreadPoolScheduling::PRIORITY) {
+        m_priority_tasks.enqueue_bulk(tasks, task_count);
+        return;
+    }
+
     m_tasks.enqueue_bulk(tasks, task_count);
 }
+
+template <hthread::InterruptibleState ThreadState>
+template <typename Prioritiser>
+    requires std::is_invocable_r_v<ui32, Prioritiser, hthread::IThreadTask<ThreadState>*>
+void hthread::ThreadPool<ThreadState>::reprioritise(Prioritiser prioritiser) {
+    if (m_scheduling != ThreadPoolScheduling::PRIORITY) return;
+
+    m_priority_tasks.reprioritise(prioritiser);
+}
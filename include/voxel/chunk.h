@@ -6,6 +6,7 @@
 #include "voxel/block.hpp"
 #include "voxel/coordinate_system.h"
 #include "voxel/chunk/constants.hpp"
+#include "voxel/chunk/block_storage.h"
 #include "voxel/chunk/events.hpp"
 #include "voxel/chunk/task.hpp"
 #include "voxel/chunk/state.hpp"
@@ -21,20 +22,27 @@ namespace hemlock {
             ~Chunk();
 
             void init(           hmem::WeakHandle<Chunk> self,
-                           hmem::Handle<ChunkBlockPager> block_pager,
-                    hmem::Handle<ChunkInstanceDataPager> instance_data_pager  );
+                    hmem::Handle<ChunkInstanceDataPager> instance_data_pager,
+                        hmem::Handle<ChunkQuadDataPager> quad_data_pager,
+                        hmem::Handle<ChunkStagingBuffer> staging_buffer = nullptr );
 
             void update(FrameTime);
 
             ChunkID id() const { return position.id; }
 
             ChunkGridPosition position;
+            // NOTE(Matthew): Set by the grid on preloading the chunk,
+            //                and what the chunk's neighbours link to.
+            ChunkSlotHandle   slot;
             Neighbours        neighbours;
 
             std::shared_mutex blocks_mutex;
-            Block*            blocks;
+            ChunkBlockStorage blocks;
 
-            RenderState render_state;
+            // NOTE(Matthew): Set by the grid, and read by mesh tasks
+            //                to determine the level of detail to
+            //                mesh at.
+            std::atomic<RenderState> render_state;
 
             ChunkInstanceManager instance;
 
@@ -42,8 +50,48 @@ namespace hemlock {
             std::atomic<ChunkTaskKind>  pending_task;
             std::atomic<bool>           gen_task_active, mesh_task_active;
 
+            // NOTE(Matthew): Set to DEAD by the grid on unloading the
+            //                chunk, after which any of its tasks still
+            //                queued or running are cancelled, even if
+            //                the chunk is kept alive by other handles.
+            std::atomic<ChunkAliveState> alive_state;
+            // NOTE(Matthew): Incremented by the grid each time a mesh
+            //                task is queued for the chunk, cancelling
+            //                any mesh task queued before it.
+            std::atomic<ui32>            mesh_epoch;
+            // NOTE(Matthew): Only touched by mesh tasks. Whether the
+            //                last mesh made of the chunk was empty, in
+            //                which case an empty mesh need not be made
+            //                again. True until the chunk is meshed, as
+            //                the renderer holds nothing of it until then.
+            std::atomic<bool>            mesh_empty;
+            // NOTE(Matthew): Whether the blocks of the chunk differ
+            //                from those on disk, or the chunk is not
+            //                on disk at all. Set by the grid on the
+            //                chunk's blocks being changed, and cleared
+            //                by the region store on loading or saving
+            //                the chunk, such that only chunks with
+            //                something new to write are saved.
+            std::atomic<bool>            modified;
+
+            // NOTE(Matthew): Only touched by the grid, on the thread
+            //                owning it. The number of the chunk's face
+            //                neighbours held by the grid that it has
+            //                not yet seen be generated, the chunk only
+            //                being meshed once this is zero. And whether
+            //                the grid has seen the chunk be generated.
+            ui32 ungenerated_neighbour_count;
+            bool generation_seen;
+
+            // NOTE(Matthew): on_block_change and on_bulk_block_change are
+            //                triggered before a change is made, and may
+            //                cancel it. on_block_changed and
+            //                on_bulk_block_changed are triggered only
+            //                once a change has actually been made.
             CancellableEvent<BlockChangeEvent>      on_block_change;
             CancellableEvent<BulkBlockChangeEvent>  on_bulk_block_change;
+            Event<BlockChangeEvent>                 on_block_changed;
+            Event<BulkBlockChangeEvent>             on_bulk_block_changed;
 
             // NOTE(Matthew): These events, at least on_mesh_change, can be
             //                called from multiple threads. Events are NOT
@@ -60,8 +108,6 @@ namespace hemlock {
             Event<>             on_unload;
         protected:
             void init_events(hmem::WeakHandle<Chunk> self);
-
-            hmem::Handle<ChunkBlockPager>           m_block_pager;
         };
 
         /**
@@ -122,6 +168,38 @@ namespace hemlock {
                   hvox::BlockChunkPosition start_block_position,
                   hvox::BlockChunkPosition end_block_position,
                                  DataType* data );
+
+        /**
+         * @brief Set all points in a rectangular cuboid of the
+         * passed in block storage to a specific block.
+         *
+         * @param storage The block storage in which to set blocks.
+         * @param start_block_position The position marking the start
+         * of the rectangular cuboid to set blocks in.
+         * @param end_block_position The position marking the end of
+         * the rectangular cuboid to set blocks in.
+         * @param block The block to set.
+         */
+        void set_per_block_data( ChunkBlockStorage& storage,
+                                BlockChunkPosition start_block_position,
+                                BlockChunkPosition end_block_position,
+                                             Block block );
+        /**
+         * @brief Set all points in a rectangular cuboid of the
+         * passed in block storage to each block in a buffer.
+         * Note, the buffer is assumed to go in x, then y, then z.
+         *
+         * @param storage The block storage in which to set blocks.
+         * @param start_block_position The position marking the start
+         * of the rectangular cuboid to set blocks in.
+         * @param end_block_position The position marking the end of
+         * the rectangular cuboid to set blocks in.
+         * @param blocks The blocks to set.
+         */
+        void set_per_block_data( ChunkBlockStorage& storage,
+                                BlockChunkPosition start_block_position,
+                                BlockChunkPosition end_block_position,
+                                            Block* blocks );
     }
 }
 namespace hvox = hemlock::voxel;
@@ -0,0 +1,221 @@
+#ifndef __hemlock_voxel_chunk_block_storage_h
+#define __hemlock_voxel_chunk_block_storage_h
+
+#include "voxel/block.hpp"
+#include "voxel/coordinate_system.h"
+#include "voxel/chunk/constants.hpp"
+#include "voxel/chunk/occupancy_pyramid.h"
+
+namespace hemlock {
+    namespace voxel {
+        static_assert(CHUNK_VOLUME <= (1 << 16), "Block storage supports at most 16-bit palette indices.");
+
+        /**
+         * @brief Paletted, bit-packed storage of the blocks of
+         * a chunk.
+         *
+         * Each distinct block in the chunk is held once in a
+         * palette, and each voxel stores an index into that
+         * palette. Indices are 1, 2, 4, 8 or 16 bits wide, and
+         * are widened on demand as the palette grows. A chunk
+         * made up of a single block stores no indices at all.
+         *
+         * The storage also keeps a summary of its occupancy, a
+         * block being solid if it is not NULL_BLOCK, such that
+         * chunks with nothing to mesh can be spotted without
+         * looking at their blocks, along with an occupancy
+         * pyramid by which rays and collision queries can step
+         * over regions of air. Chunks left with no solid blocks,
+         * or solid throughout with a single block, are collapsed
+         * back to being uniform.
+         *
+         * NOTE: this is not thread-safe, callers are expected
+         * to hold the owning chunk's blocks_mutex.
+         */
+        class ChunkBlockStorage {
+        public:
+            ChunkBlockStorage();
+            ~ChunkBlockStorage();
+
+            ChunkBlockStorage(const ChunkBlockStorage&)            = delete;
+            ChunkBlockStorage& operator=(const ChunkBlockStorage&) = delete;
+
+            /**
+             * @brief Initialises the storage as a uniform
+             * chunk of the given block.
+             *
+             * @param block The block filling the chunk.
+             */
+            void init(Block block = NULL_BLOCK);
+            /**
+             * @brief Releases all memory held by the storage.
+             */
+            void dispose();
+
+            /**
+             * @brief Gets the block at the given index.
+             *
+             * @param index The index of the block in the chunk.
+             * @return Block The block at that index.
+             */
+            Block get(BlockIndex index) const;
+            Block operator[](BlockIndex index) const { return get(index); }
+
+            /**
+             * @brief Sets the block at the given index.
+             *
+             * @param index The index of the block in the chunk.
+             * @param block The block to set.
+             */
+            void set(BlockIndex index, Block block);
+
+            /**
+             * @brief Sets the whole chunk to a single block,
+             * releasing any index storage.
+             *
+             * @param block The block to set.
+             */
+            void fill(Block block);
+            /**
+             * @brief Sets all blocks in the rectangular cuboid
+             * spanning start to end inclusive to a single block.
+             *
+             * @param start The near bottom left of the cuboid.
+             * @param end The far top right of the cuboid.
+             * @param block The block to set.
+             */
+            void fill(BlockChunkPosition start, BlockChunkPosition end, Block block);
+            /**
+             * @brief Sets all blocks in the rectangular cuboid
+             * spanning start to end inclusive from a buffer. The
+             * buffer is assumed to go in x, then y, then z.
+             *
+             * @param start The near bottom left of the cuboid.
+             * @param end The far top right of the cuboid.
+             * @param blocks The blocks to set.
+             */
+            void copy(BlockChunkPosition start, BlockChunkPosition end, const Block* blocks);
+
+            /**
+             * @brief Writes every block of the chunk into the
+             * buffer provided, which must hold CHUNK_VOLUME
+             * blocks.
+             *
+             * @param buffer The buffer to unpack into.
+             */
+            void unpack(Block* buffer) const;
+
+            /**
+             * @brief Appends a compact binary representation of
+             * the storage to the buffer provided.
+             *
+             * @param buffer The buffer to append to.
+             */
+            void serialise(OUT std::vector<ui8>& buffer) const;
+            /**
+             * @brief Replaces the contents of the storage with
+             * those encoded in the given data, as produced by
+             * serialise.
+             *
+             * @param data The serialised storage.
+             * @param length The length of the data in bytes.
+             * @return True if the data was valid, false otherwise,
+             * in which case the storage is left unchanged.
+             */
+            bool deserialise(const ui8* data, size_t length);
+
+            /**
+             * @brief Drops palette entries no longer referenced
+             * by any voxel, narrowing indices where possible.
+             *
+             * This is done whenever a new block would otherwise
+             * widen indices, so need only be called to reclaim
+             * memory sooner.
+             */
+            void compact();
+
+            bool  is_uniform()    const { return m_index_bits == 0; }
+            Block uniform_block() const { return m_palette[0];      }
+
+            /**
+             * @brief The number of solid blocks in the chunk.
+             */
+            ui32 solid_count() const { return m_solid_count;                 }
+            bool is_empty()    const { return m_solid_count == 0;            }
+            bool is_full()     const { return m_solid_count == CHUNK_VOLUME; }
+
+            /**
+             * @brief Gets a mask of the faces of the chunk made up
+             * only of solid blocks, bit i being set for the face
+             * whose BlockFace value is i.
+             */
+            ui8 solid_faces() const;
+
+            /**
+             * @brief The occupancy pyramid of the chunk.
+             */
+            const ChunkOccupancyPyramid& occupancy() const { return m_occupancy; }
+
+            ui8    index_bits()   const { return m_index_bits;      }
+            size_t palette_size() const { return m_palette.size();  }
+
+            /**
+             * @brief The number of bytes of heap memory held by
+             * the storage.
+             */
+            size_t memory_usage() const;
+        protected:
+            /**
+             * @brief Finds the palette index of the given block,
+             * adding it to the palette and widening indices if
+             * needed.
+             */
+            ui32 palette_index(Block block);
+
+            /**
+             * @brief Repacks all indices at the given width.
+             */
+            void repack(ui8 index_bits);
+
+            /**
+             * @brief Updates the occupancy summary for a change
+             * of the block at the given index.
+             *
+             * @param propagate Whether to update the levels of the
+             * occupancy pyramid above the block, if not the caller
+             * is to rebuild the pyramid once done.
+             */
+            void track_occupancy(BlockIndex index, Block old_block, Block block, bool propagate = true);
+            /**
+             * @brief Sets the occupancy summary to that of a chunk
+             * made up of the given block.
+             */
+            void reset_occupancy(Block block);
+            /**
+             * @brief Becomes uniform if the occupancy summary shows
+             * the chunk holds a single block.
+             */
+            void collapse_if_uniform();
+
+            ui32 index_at(BlockIndex index) const;
+            void set_index_at(BlockIndex index, ui32 palette_idx);
+
+            static size_t word_count(ui8 index_bits) {
+                return (CHUNK_VOLUME * static_cast<size_t>(index_bits) + 63) / 64;
+            }
+
+            std::vector<Block>  m_palette;
+            ui64*               m_indices;
+            ui8                 m_index_bits;
+            ui8                 m_index_bits_log2;
+
+            ui32                m_solid_count;
+            ui32                m_face_solid_counts[6];
+
+            ChunkOccupancyPyramid m_occupancy;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_chunk_block_storage_h
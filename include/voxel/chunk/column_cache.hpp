@@ -0,0 +1,67 @@
+#ifndef __hemlock_voxel_chunk_column_cache_hpp
+#define __hemlock_voxel_chunk_column_cache_hpp
+
+#include "voxel/coordinate_system.h"
+
+namespace hemlock {
+    namespace voxel {
+        /**
+         * @brief Least-recently-used cache of data generated per
+         * column of chunks, such as heightmaps, biomes and surface
+         * data, that would otherwise be computed again for each
+         * chunk in the column.
+         *
+         * The data of a column is built by the first chunk in the
+         * column to fetch it and is then shared, read-only, by the
+         * rest. Chunks of the column fetching it while it is still
+         * being built wait on it rather than build it again.
+         *
+         * NOTE: this is thread-safe. Data evicted from the cache
+         * lives on until the last handle on it is dropped.
+         */
+        template <typename ColumnData>
+        class ChunkColumnCache {
+        public:
+            ChunkColumnCache(size_t capacity);
+            ~ChunkColumnCache() { /* Empty. */ }
+
+            /**
+             * @brief Fetches the data of the given column, building
+             * it if it is not already cached.
+             *
+             * @param column The column whose data to fetch.
+             * @param build Builds the data of the column, called as
+             * build(column, data) on the calling thread.
+             * @return Handle on the column's data.
+             */
+            template <typename Builder>
+                requires std::is_invocable_v<Builder, ColumnWorldPosition, ColumnData&>
+            hmem::Handle<const ColumnData> fetch(ColumnWorldPosition column, Builder&& build);
+
+            /**
+             * @brief Evicts all columns from the cache.
+             */
+            void clear();
+
+            size_t capacity() const { return m_capacity; }
+        protected:
+            struct Entry {
+                std::once_flag built;
+                ColumnData     data;
+            };
+
+            using Recency = std::list<ColumnID>;
+
+            std::mutex  m_mutex;
+            size_t      m_capacity;
+            // Most recently fetched at the front.
+            Recency     m_recency;
+            std::unordered_map<ColumnID, std::pair<hmem::Handle<Entry>, typename Recency::iterator>> m_entries;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#include "voxel/chunk/column_cache.inl"
+
+#endif // __hemlock_voxel_chunk_column_cache_hpp
@@ -0,0 +1,47 @@
+template <typename ColumnData>
+hvox::ChunkColumnCache<ColumnData>::ChunkColumnCache(size_t capacity) :
+    m_capacity(capacity)
+{ /* Empty. */ }
+
+template <typename ColumnData>
+template <typename Builder>
+    requires std::is_invocable_v<Builder, hvox::ColumnWorldPosition, ColumnData&>
+hmem::Handle<const ColumnData> hvox::ChunkColumnCache<ColumnData>::fetch(ColumnWorldPosition column, Builder&& build) {
+    hmem::Handle<Entry> entry;
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto it = m_entries.find(column.id);
+        if (it != m_entries.end()) {
+            entry = it->second.first;
+
+            m_recency.splice(m_recency.begin(), m_recency, it->second.second);
+        } else {
+            entry = hmem::make_handle<Entry>();
+
+            m_recency.emplace_front(column.id);
+            m_entries.emplace(column.id, std::make_pair(entry, m_recency.begin()));
+
+            if (m_entries.size() > m_capacity) {
+                m_entries.erase(m_recency.back());
+                m_recency.pop_back();
+            }
+        }
+    }
+
+    // Built outside of the lock, so that columns can be built
+    // in parallel.
+    std::call_once(entry->built, [&]() {
+        build(column, entry->data);
+    });
+
+    return hmem::Handle<const ColumnData>(entry, &entry->data);
+}
+
+template <typename ColumnData>
+void hvox::ChunkColumnCache<ColumnData>::clear() {
+    std::lock_guard lock(m_mutex);
+
+    m_entries.clear();
+    m_recency.clear();
+}
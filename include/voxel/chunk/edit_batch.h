@@ -0,0 +1,94 @@
+#ifndef __hemlock_voxel_chunk_edit_batch_h
+#define __hemlock_voxel_chunk_edit_batch_h
+
+#include "voxel/block.hpp"
+#include "voxel/coordinate_system.h"
+
+namespace hemlock {
+    namespace voxel {
+        class ChunkGrid;
+
+        /**
+         * @brief Accumulates block edits in world space, to be
+         * applied to a chunk grid all at once.
+         *
+         * On commit, edits are sorted by the chunk they fall in,
+         * and each chunk is then locked just the once to apply
+         * all of its edits, firing a single bulk block change
+         * event for them rather than one event per block. Edits
+         * that fill the bounding box of those to a chunk, as is
+         * the case for placing a structure, are copied in with
+         * set_per_block_data.
+         *
+         * Each chunk is locked exclusively just the once, under
+         * which the bulk block change event is fired and the edits
+         * applied, so that the blocks given to subscribers are
+         * exactly those written. Subscribers to on_bulk_block_change
+         * must therefore not lock the chunk's blocks themselves.
+         *
+         * As chunks are applied one at a time, a batch is all-or-
+         * nothing per chunk rather than across chunks: if the bulk
+         * block change of a chunk is cancelled, only the edits to
+         * that chunk are dropped, those to chunks before it having
+         * already been applied.
+         */
+        class BlockEditBatch {
+        public:
+            BlockEditBatch()  { /* Empty. */ }
+            ~BlockEditBatch() { /* Empty. */ }
+
+            /**
+             * @brief Adds an edit to the batch. Of edits made at
+             * the same position, the last one added wins.
+             *
+             * @param position The position of the block to set.
+             * @param block The block to set.
+             */
+            void set_block(BlockWorldPosition position, Block block);
+            /**
+             * @brief Adds an edit to the batch for each point of
+             * a rectangular cuboid.
+             *
+             * @param start The near bottom left of the cuboid.
+             * @param end The far top right of the cuboid.
+             * @param block The block to set.
+             */
+            void set_blocks(BlockWorldPosition start, BlockWorldPosition end, Block block);
+
+            /**
+             * @brief Applies the edits of the batch to the chunks
+             * of the given grid, after which the batch is empty.
+             * Edits in chunks not held by the grid are dropped.
+             *
+             * NOTE: this must be called from the thread owning the
+             * grid, as chunks are looked up in it.
+             *
+             * @param grid_handle Handle to the chunk grid to apply
+             * the edits to.
+             * @return True if the edits were applied, false if the
+             * edits to any chunk were cancelled or the grid no longer
+             * exists.
+             */
+            bool commit(hmem::WeakHandle<ChunkGrid> grid_handle);
+
+            /**
+             * @brief Drops all edits of the batch.
+             */
+            void clear() { m_edits.clear(); }
+
+            size_t size()  const { return m_edits.size();  }
+            bool   empty() const { return m_edits.empty(); }
+        protected:
+            struct Edit {
+                ChunkID     chunk_id;
+                BlockIndex  block_index;
+                Block       block;
+            };
+
+            std::vector<Edit> m_edits;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_chunk_edit_batch_h
@@ -1,6 +1,7 @@
 #ifndef __hemlock_voxel_chunk_generator_h
 #define __hemlock_voxel_chunk_generator_h
 
+#include "voxel/chunk/column_cache.hpp"
 #include "voxel/chunk/task.hpp"
 #include "voxel/coordinate_system.h"
 
@@ -9,22 +10,73 @@ namespace hemlock {
         struct Chunk;
 
         /**
-         * @brief Defines a struct whose opeartor() sets the blocks of a chunk.
+         * @brief Defines a generation strategy that first builds data
+         * shared by the whole column of chunks in which a chunk lies,
+         * such as heightmaps, biomes and surface data. The data of a
+         * column is built by generate_column for the first chunk of
+         * the column to be generated, cached, and then passed on to
+         * operator() for each chunk in the column.
+         *
+         * A strategy may set COLUMN_CACHE_CAPACITY to the number of
+         * columns whose data is kept at any one time.
          */
         template <typename StrategyCandidate>
-        concept ChunkGenerationStrategy = requires (
-             StrategyCandidate s,
-           hmem::Handle<Chunk> c
+        concept ChunkColumnGenerationStrategy = requires (
+                              StrategyCandidate s,
+                            hmem::Handle<Chunk> c,
+                            ColumnWorldPosition p,
+            typename StrategyCandidate::ColumnData d
         ) {
-            { s.operator()(c) } -> std::same_as<void>;
+            { s.generate_column(p, d) } -> std::same_as<void>;
+            { s.operator()(c, std::as_const(d)) } -> std::same_as<void>;
         };
 
+        /**
+         * @brief Defines a struct whose operator() sets the blocks of a chunk.
+         *
+         * A strategy is constructed just the once on each thread that
+         * generates chunks with it, and is then kept for the life of
+         * that thread. Expensive set up, such as building a graph of
+         * noise nodes, belongs in its constructor, and it may keep
+         * scratch buffers between calls, operator() being free to be
+         * non-const. It is never shared between threads.
+         */
+        template <typename StrategyCandidate>
+        concept ChunkGenerationStrategy = std::default_initializable<StrategyCandidate>
+            && (
+                requires (
+                     StrategyCandidate s,
+                   hmem::Handle<Chunk> c
+                ) {
+                    { s.operator()(c) } -> std::same_as<void>;
+                } || ChunkColumnGenerationStrategy<StrategyCandidate>
+            );
+
         template <hvox::ChunkGenerationStrategy GenerationStrategy>
         class ChunkGenerationTask : public ChunkTask {
         public:
             virtual ~ChunkGenerationTask() { /* Empty. */ }
 
             virtual void execute(ChunkLoadThreadState* state, ChunkTaskQueue* task_queue) override;
+        protected:
+            /**
+             * @brief The generation strategy of the calling thread,
+             * constructed on first use by that thread.
+             */
+            static GenerationStrategy& strategy();
+
+            /**
+             * @brief The cache of column data shared by all threads
+             * generating chunks with the strategy.
+             */
+            static auto& column_cache() requires ChunkColumnGenerationStrategy<GenerationStrategy>;
+
+            /**
+             * @brief Generates the chunk with the strategy of the
+             * calling thread, passing along the data of its column
+             * if the strategy builds any.
+             */
+            static void generate(hmem::Handle<Chunk> chunk);
         };
     }
 }
@@ -3,6 +3,50 @@
 // #include "voxel/chunk/mesh/greedy_task.hpp"
 #include "voxel/chunk/mesh/naive_task.hpp"
 
+template <hvox::ChunkGenerationStrategy GenerationStrategy>
+GenerationStrategy& hvox::ChunkGenerationTask<GenerationStrategy>::strategy() {
+    // NOTE(Matthew): Destroyed as the worker thread exits, so when
+    //                the owning thread pool is disposed of.
+    thread_local GenerationStrategy generate{};
+
+    return generate;
+}
+
+template <hvox::ChunkGenerationStrategy GenerationStrategy>
+auto& hvox::ChunkGenerationTask<GenerationStrategy>::column_cache()
+    requires ChunkColumnGenerationStrategy<GenerationStrategy>
+{
+    using ColumnData = typename GenerationStrategy::ColumnData;
+
+    constexpr size_t capacity = [] {
+        if constexpr (requires { GenerationStrategy::COLUMN_CACHE_CAPACITY; }) {
+            return static_cast<size_t>(GenerationStrategy::COLUMN_CACHE_CAPACITY);
+        } else {
+            return size_t{1024};
+        }
+    }();
+
+    static ChunkColumnCache<ColumnData> cache{capacity};
+
+    return cache;
+}
+
+template <hvox::ChunkGenerationStrategy GenerationStrategy>
+void hvox::ChunkGenerationTask<GenerationStrategy>::generate(hmem::Handle<Chunk> chunk) {
+    if constexpr (ChunkColumnGenerationStrategy<GenerationStrategy>) {
+        auto column = column_cache().fetch(
+            column_world_position(chunk->position),
+            [](ColumnWorldPosition position, typename GenerationStrategy::ColumnData& data) {
+                strategy().generate_column(position, data);
+            }
+        );
+
+        strategy()(chunk, *column);
+    } else {
+        strategy()(chunk);
+    }
+}
+
 template <hvox::ChunkGenerationStrategy GenerationStrategy>
 void hvox::ChunkGenerationTask<GenerationStrategy>::execute(ChunkLoadThreadState*, ChunkTaskQueue*) {
     auto chunk = m_chunk.lock();
@@ -11,8 +55,6 @@ void hvox::ChunkGenerationTask<GenerationStrategy>::execute(ChunkLoadThreadState
 
     chunk->gen_task_active.store(true, std::memory_order_release);
 
-    const GenerationStrategy generate{};
-
     generate(chunk);
 
     chunk->state.store(ChunkState::GENERATED, std::memory_order_release);
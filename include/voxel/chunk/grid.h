@@ -4,6 +4,8 @@
 #include "timing.h"
 #include "voxel/coordinate_system.h"
 #include "voxel/chunk.h"
+#include "voxel/chunk/index.h"
+#include "voxel/chunk/slot_map.h"
 #include "voxel/chunk/task.hpp"
 #include "voxel/chunk/renderer.h"
 
@@ -17,13 +19,45 @@ namespace hemlock {
         //                the former grabs a page only if needed (as we are in the meshers), and the latter returns a handle on the to-be-freed data. Or
         //                something like that.
 
-        using Chunks = std::unordered_map<ChunkID, hmem::Handle<Chunk>>;
+        using Chunks = ChunkIndex;
 
         using QueriedChunkState       = std::pair<bool, bool>;
         using QueriedChunkPendingTask = std::pair<bool, bool>;
 
         using ChunkTaskBuilder = Delegate<ChunkTask*(void)>;
 
+        /**
+         * @brief The shape of the volume of chunks kept loaded
+         * about the streaming focus.
+         *
+         * SPHERE keeps chunks within the view distance of the
+         * focus in all directions, CYLINDER keeps chunks within
+         * the view distance of the focus in x and z, and within
+         * a fixed range of chunk y coordinates.
+         */
+        enum class ChunkStreamShape : ui8 {
+            SPHERE,
+            CYLINDER
+        };
+
+        /**
+         * @brief Settings of the chunk streaming done by the
+         * chunk grid, see ChunkGrid::set_streaming.
+         */
+        struct ChunkStreamSettings {
+            ChunkStreamShape shape;
+            // The radius, in chunks, of the volume kept loaded. Zero
+            // turns streaming off.
+            ui32             view_distance;
+            // The inclusive range of chunk y coordinates kept loaded
+            // when the shape is CYLINDER.
+            i64              min_y, max_y;
+            // The most chunks whose loads are submitted per update.
+            ui32             load_budget;
+        };
+
+        class ChunkRegionStore;
+
         class ChunkGrid {
         public:
             ChunkGrid();
@@ -41,30 +75,49 @@ namespace hemlock {
              * otherwise generate it.
              * @param build_mesh_task Builder that returns a valid
              * task to mesh a chunk.
+             * @param region_store Optional store through which
+             * chunks are loaded from and saved to disk. If not
+             * provided, chunks are never persisted.
+             * @param mesh_output The kind of mesh the tasks built
+             * by build_mesh_task output, which the renderer will
+             * draw.
+             * @param draw_mode How the renderer is to draw chunks.
              */
             void init( hmem::WeakHandle<ChunkGrid> self,
                                               ui32 thread_count,
                                   ChunkTaskBuilder build_load_or_generate_task,
-                                  ChunkTaskBuilder build_mesh_task );
+                                  ChunkTaskBuilder build_mesh_task,
+                  hmem::Handle<ChunkRegionStore> region_store = nullptr,
+                                 ChunkMeshOutput mesh_output  = ChunkMeshOutput::CUBOID_INSTANCES,
+                                   ChunkDrawMode draw_mode    = ChunkDrawMode::PER_PAGE );
             /**
              * @brief Disposes of the chunk grid, ending
              * the tasks on the thread pool and unloading
-             * all chunks.
+             * all chunks, saving them if a region store
+             * was provided.
              */
             void dispose();
 
             /**
-             * @brief Update loop for chunks.
+             * @brief Update loop for chunks. Any chunks marked
+             * dirty since the last update are queued to be
+             * remeshed here, once each.
              *
              * @param time The time data for the frame.
              */
             void update(FrameTime time);
             /**
-             * @brief Draw loop for chunks.
+             * @brief Draw loop for chunks, drawing those
+             * within the camera's frustum.
              *
              * @param time The time data for the frame.
+             * @param camera The camera drawn from, any meeting
+             * hcam::Camera as in camera/camera_concept.hpp.
              */
-            void draw(FrameTime time);
+            template <typename CameraType>
+            void draw(FrameTime time, CameraType* camera) {
+                m_renderer.draw(time, camera);
+            }
 
             // TODO(Matthew): move this out of here. we should look
             //                at Vulkan for how we might better architect drawing.
@@ -85,8 +138,78 @@ namespace hemlock {
              */
             void resume_chunk_tasks()  { m_thread_pool.resume();  }
 
+            /**
+             * @brief Sets the distance, in chunks, beyond which
+             * chunks are drawn at a lower level of detail. Chunks
+             * at least this far from the view position are at LOD_7,
+             * at least twice this far at LOD_6, and so on. Distance
+             * is measured along whichever axis it is greatest.
+             *
+             * NOTE: only mesh tasks that honour a chunk's render
+             * state, such as ChunkBinaryGreedyMeshTask, will mesh
+             * at lower levels of detail.
+             *
+             * @param lod_distance The distance beyond which chunks
+             * are drawn at a lower level of detail, zero meaning
+             * all chunks are drawn at full detail.
+             */
+            void set_lod_distance(ui32 lod_distance);
+            ui32 lod_distance() const { return m_lod_distance; }
+
+            /**
+             * @brief Gives each chunk the render state for its
+             * distance from the view position, queueing any chunk
+             * whose render state changes to be remeshed. Chunks
+             * are only revisited when the view position moves into
+             * a different chunk.
+             *
+             * If streaming is off, chunk tasks are also prioritised
+             * by distance from the view position, those waiting to
+             * be run being reprioritised as it moves.
+             *
+             * @param view_position The world position, in blocks,
+             * from which chunks are viewed.
+             */
+            void update_render_states(const f32v3& view_position);
+
+            /**
+             * @brief Sets how chunks are streamed in and out about
+             * the streaming focus. Once set, the grid owns which
+             * chunks are loaded: any chunk outside the streamed
+             * volume is unloaded on the next call to
+             * update_streaming, however it came to be loaded.
+             *
+             * @param settings The streaming settings, a view
+             * distance of zero turning streaming off.
+             */
+            void set_streaming(const ChunkStreamSettings& settings);
+            const ChunkStreamSettings& streaming() const { return m_stream_settings; }
+
+            /**
+             * @brief Streams chunks about the focus. When the focus
+             * moves into a different chunk, all chunks now outside
+             * the streamed volume are unloaded and those inside it
+             * but not yet loaded are queued nearest first. Each call
+             * then submits loads for at most the load budget of the
+             * queued chunks, so that nearby chunks are always loaded
+             * first and the thread pool is never flooded with loads
+             * of far-away chunks.
+             *
+             * The chunk tasks waiting to be run are also reprioritised
+             * as the focus moves, such that those for chunks nearest
+             * the focus are run first.
+             *
+             * @param focus The world position, in blocks, about
+             * which chunks are streamed.
+             */
+            void update_streaming(const f32v3& focus);
+
             ChunkRenderer* renderer() { return &m_renderer; }
 
+            ChunkRegionStore* region_store() { return m_region_store.get(); }
+
+            ChunkSlotMap& chunk_slots() { return m_chunk_slots; }
+
             /**
              * @brief Loads chunks with the assumption none specified
              * have even been preloaded. This is useful as it assures
@@ -139,8 +262,9 @@ namespace hemlock {
             bool load_from_scratch_chunk_at(ChunkGridPosition chunk_position);
             /**
              * @brief Unloads a chunk, this entails ending all
-             * pending tasks for this chunk and releasing memory
-             * associated with it.
+             * pending tasks for this chunk, saving it if a region
+             * store was provided and releasing memory associated
+             * with it.
              *
              * NOTE: this is a non-blocking action, and the chunk
              * will only release memory once all active queries and
@@ -417,23 +541,138 @@ namespace hemlock {
              */
             hmem::Handle<Chunk> chunk(ChunkGridPosition position) { return chunk(position.id); }
 
+            /**
+             * @brief Marks the chunk at the given position as
+             * needing to be remeshed. Chunks so marked are
+             * queued for remeshing on the next update.
+             *
+             * NOTE: this is thread-safe.
+             *
+             * @param chunk_position The position of the chunk
+             * to mark as dirty.
+             */
+            void mark_chunk_dirty(ChunkGridPosition chunk_position);
+            /**
+             * @brief Marks the chunk at the given position as
+             * needing to be remeshed, along with any neighbours
+             * sharing a face with the rectangular cuboid of blocks
+             * spanning start to end inclusive.
+             *
+             * NOTE: this is thread-safe.
+             *
+             * @param chunk_position The position of the chunk
+             * to mark as dirty.
+             * @param start_block_position The near bottom left of
+             * the changed blocks.
+             * @param end_block_position The far top right of the
+             * changed blocks.
+             */
+            void mark_chunk_dirty( ChunkGridPosition chunk_position,
+                                  BlockChunkPosition start_block_position,
+                                  BlockChunkPosition end_block_position );
+
+            // NOTE(Matthew): Triggered on the thread owning the grid
+            //                as each chunk is preloaded, before any
+            //                task is queued for it. Being that chunk
+            //                events are not thread-safe, this is the
+            //                point at which anything outside the grid
+            //                should subscribe to them.
+            Event<hmem::Handle<Chunk>> on_chunk_preload;
         protected:
             void establish_chunk_neighbours(hmem::Handle<Chunk> chunk);
 
-            Delegate<void(Sender)>                      handle_chunk_load;
-            Delegate<bool(Sender, BlockChangeEvent)>    handle_block_change;
+            /**
+             * @brief Calls the given function with each face
+             * neighbour of the chunk at the given position that
+             * is held by the grid.
+             */
+            void for_each_neighbour(ChunkGridPosition chunk_position, Delegate<void(hmem::Handle<Chunk>)> func);
+
+            /**
+             * @brief Counts down the ungenerated neighbours of each
+             * neighbour of a chunk generated or unloaded before
+             * being generated, marking dirty those left waiting on
+             * no more neighbours.
+             */
+            void release_neighbours(ChunkGridPosition chunk_position);
+
+            /**
+             * @brief Records the generation of each chunk generated
+             * since the last call, marking dirty it and any of its
+             * neighbours now waiting on no more neighbours.
+             */
+            void process_generated_chunks();
+
+            /**
+             * @brief Queues a mesh task for each chunk marked
+             * dirty since the last call, skipping any with
+             * neighbours still to be generated.
+             */
+            void process_dirty_chunks();
+
+            /**
+             * @brief The render state a chunk at the given position
+             * should have, given the current view position.
+             */
+            RenderState render_state_at(ChunkGridPosition chunk_position) const;
+            /**
+             * @brief Sets the chunk's render state, if different,
+             * triggering its render state change event and marking
+             * it dirty to be remeshed.
+             */
+            void set_render_state(hmem::Handle<Chunk> chunk, RenderState render_state);
+
+            /**
+             * @brief Whether the chunk at the given position is
+             * within the volume streamed about the current focus.
+             */
+            bool in_stream_volume(ChunkGridPosition chunk_position) const;
+            /**
+             * @brief Unloads chunks outside of the streamed volume
+             * and queues those inside it that are not yet loaded.
+             */
+            void restream();
+            /**
+             * @brief The priority of tasks for the chunk at the given
+             * position, chunks nearer the focus being of lower value
+             * and so run first. The focus is the streaming focus if
+             * streaming is on, otherwise the view position last given
+             * to update_render_states.
+             */
+            ui32 task_priority(ChunkGridPosition chunk_position) const;
+
+            Delegate<void(Sender)>                          handle_chunk_load;
+            Delegate<void(Sender, BlockChangeEvent)>        handle_block_change;
+            Delegate<void(Sender, BulkBlockChangeEvent)>    handle_bulk_block_change;
 
             ChunkTaskBuilder m_build_load_or_generate_task, m_build_mesh_task;
             thread::ThreadPool<ChunkTaskContext> m_thread_pool;
 
             ChunkAllocator m_chunk_allocator;
 
-            hmem::Handle<ChunkBlockPager>           m_block_pager;
             hmem::Handle<ChunkInstanceDataPager>    m_instance_data_pager;
+            hmem::Handle<ChunkQuadDataPager>        m_quad_data_pager;
+            hmem::Handle<ChunkRegionStore>          m_region_store;
 
             ChunkRenderer m_renderer;
 
-            Chunks m_chunks;
+            Chunks          m_chunks;
+            ChunkSlotMap    m_chunk_slots;
+
+            std::mutex                  m_dirty_chunks_mutex;
+            std::unordered_set<ChunkID> m_dirty_chunks;
+
+            std::mutex                  m_generated_chunks_mutex;
+            std::vector<HandleAndID>    m_generated_chunks;
+
+            ui32                m_lod_distance;
+            ChunkGridPosition   m_lod_view_position;
+
+            ChunkStreamSettings             m_stream_settings;
+            ChunkGridPosition               m_stream_focus_position;
+            bool                            m_stream_stale;
+            // Sorted furthest first, so the nearest chunk is at the back.
+            std::vector<ChunkGridPosition>  m_stream_queue;
 
             hmem::WeakHandle<ChunkGrid> m_self;
 
@@ -0,0 +1,125 @@
+#ifndef __hemlock_voxel_chunk_index_h
+#define __hemlock_voxel_chunk_index_h
+
+#include "voxel/coordinate_system.h"
+
+namespace hemlock {
+    namespace voxel {
+        struct Chunk;
+
+        /**
+         * @brief Index of the chunks held by a chunk grid, mapping
+         * chunk IDs to handles on the chunks.
+         *
+         * Chunks are held contiguously, such that iterating over
+         * them is cache-friendly, and are found through a flat,
+         * open-addressed table of the IDs of the chunks and their
+         * place in that array. The table is linearly probed, with
+         * the ID mixed such that neighbouring chunks are scattered
+         * across it, and entries are shifted back into place on
+         * erasure so that no tombstones are ever left to probe
+         * through.
+         *
+         * NOTE: as with std::vector, inserting or erasing a chunk
+         * invalidates all iterators. Erasing moves the last chunk
+         * into the place of the erased one.
+         */
+        class ChunkIndex {
+        public:
+            using Entry          = std::pair<ChunkID, hmem::Handle<Chunk>>;
+            using Entries        = std::vector<Entry>;
+            using iterator       = Entries::iterator;
+            using const_iterator = Entries::const_iterator;
+
+            ChunkIndex();
+            ~ChunkIndex() { /* Empty. */ }
+
+            iterator       begin()       { return m_entries.begin(); }
+            iterator       end()         { return m_entries.end();   }
+            const_iterator begin() const { return m_entries.begin(); }
+            const_iterator end()   const { return m_entries.end();   }
+
+            size_t size()  const { return m_entries.size();  }
+            bool   empty() const { return m_entries.empty(); }
+
+            /**
+             * @brief Finds the chunk of the given ID.
+             *
+             * @param id The ID of the chunk to find.
+             * @return An iterator to the chunk's entry if held, the
+             * end iterator otherwise.
+             */
+            iterator find(ChunkID id);
+            /**
+             * @brief Finds the chunk at the given offset, in chunks,
+             * from the given position, such as one of its neighbours.
+             *
+             * @param position The position offset from.
+             * @param offset The offset from that position.
+             * @return An iterator to the chunk's entry if held, the
+             * end iterator otherwise.
+             */
+            iterator find(ChunkGridPosition position, i32v3 offset);
+
+            bool contains(ChunkID id) const { return find_slot(id) != NO_SLOT; }
+
+            /**
+             * @brief Gets the handle held for the chunk of the given
+             * ID, inserting an empty handle for it if none is held.
+             *
+             * @param id The ID of the chunk.
+             * @return The handle held for the chunk.
+             */
+            hmem::Handle<Chunk>& operator[](ChunkID id);
+
+            /**
+             * @brief Erases the chunk pointed to by the iterator.
+             *
+             * @param it The iterator to the chunk's entry.
+             */
+            void erase(iterator it);
+            /**
+             * @brief Erases the chunk of the given ID, if held.
+             *
+             * @param id The ID of the chunk to erase.
+             * @return True if the chunk was held, false otherwise.
+             */
+            bool erase(ChunkID id);
+
+            /**
+             * @brief Erases all chunks, releasing all memory held.
+             */
+            void clear();
+        protected:
+            static constexpr size_t NO_SLOT  = std::numeric_limits<size_t>::max();
+            static constexpr ui32   NO_ENTRY = std::numeric_limits<ui32>::max();
+
+            struct Slot {
+                ChunkID id;
+                ui32    entry_idx;
+            };
+
+            static ui64 mix(ChunkID id);
+
+            size_t home_slot(ChunkID id) const { return mix(id) & (m_slots.size() - 1); }
+
+            /**
+             * @brief The slot holding the given ID, or NO_SLOT if
+             * none does.
+             */
+            size_t find_slot(ChunkID id) const;
+
+            /**
+             * @brief Rebuilds the table with the given number of
+             * slots, which must be a power of two.
+             */
+            void rehash(size_t slot_count);
+
+            std::vector<Slot>   m_slots;
+            Entries             m_entries;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_chunk_index_h
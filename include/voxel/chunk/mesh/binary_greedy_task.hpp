@@ -0,0 +1,61 @@
+#ifndef __hemlock_voxel_chunk_mesh_binary_greedy_h
+#define __hemlock_voxel_chunk_mesh_binary_greedy_h
+
+#include "voxel/chunk/task.hpp"
+#include "voxel/chunk/mesh/instance_manager.h"
+#include "voxel/chunk/mesh/mesh_task.hpp"
+
+namespace hemlock {
+    namespace voxel {
+        static_assert(CHUNK_LENGTH <= 64, "Binary greedy meshing supports chunks at most 64 blocks long.");
+
+        /**
+         * @brief Bitmask of a single column of blocks along the
+         * x-axis of a chunk, bit x representing the block at x.
+         */
+        using BlockColumnMask = std::conditional_t<(CHUNK_LENGTH <= 32), ui32, ui64>;
+
+        /**
+         * @brief Greedy mesher working on bitmasks of columns of
+         * blocks rather than block-by-block.
+         *
+         * For each kind of instanceable block, the chunk is
+         * reduced to one bitmask per column. Blocks with no
+         * visible face are found by shifting and ANDing the
+         * occupancy of adjacent columns (including the faces of
+         * neighbouring chunks), and the remaining blocks are
+         * greedily covered with cuboids, extending runs of set
+         * bits first in x, then z, then y.
+         *
+         * If outputting face quads, each kind instead has one
+         * bitmask per face direction of the faces that are
+         * visible, and each plane of these is greedily covered
+         * with rectangles.
+         *
+         * Chunks at a lower level of detail than FULL are first
+         * downsampled into cells of lod_cell_length blocks, each
+         * taking on the majority of its blocks, and have all faces
+         * on their border drawn.
+         *
+         * NOTE: the comparator is evaluated once per distinct
+         * block rather than once per position, so comparators
+         * whose result depends on position should stick to the
+         * other mesh tasks.
+         */
+        template <
+            hvox::ChunkMeshComparator MeshComparator,
+            ChunkMeshOutput           MeshOutput      = ChunkMeshOutput::CUBOID_INSTANCES
+        >
+        class ChunkBinaryGreedyMeshTask : public ChunkTask {
+        public:
+            virtual ~ChunkBinaryGreedyMeshTask() { /* Empty. */ }
+
+            virtual void execute(ChunkLoadThreadState* state, ChunkTaskQueue* task_queue) override;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#include "voxel/chunk/mesh/binary_greedy_task.inl"
+
+#endif // __hemlock_voxel_chunk_mesh_binary_greedy_h
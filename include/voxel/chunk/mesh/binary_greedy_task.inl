@@ -0,0 +1,568 @@
+#include "graphics/mesh.h"
+#include "voxel/block.hpp"
+#include "voxel/chunk.h"
+#include "voxel/chunk/grid.h"
+
+template <hvox::ChunkMeshComparator MeshComparator, hvox::ChunkMeshOutput MeshOutput>
+void hvox::ChunkBinaryGreedyMeshTask<MeshComparator, MeshOutput>::execute(ChunkLoadThreadState*, ChunkTaskQueue*) {
+    auto chunk_grid = m_chunk_grid.lock();
+    if (chunk_grid == nullptr) return;
+    auto chunk = m_chunk.lock();
+    if (chunk == nullptr) return;
+
+    chunk->mesh_task_active.store(true, std::memory_order_release);
+
+    // Chunks with nothing to mesh, such as those of only air,
+    // skip the mesh pass entirely.
+    if (complete_if_empty_mesh(chunk.get(), MeshOutput == ChunkMeshOutput::FACE_QUADS)) return;
+
+    constexpr ui32 COLUMN_BITS = sizeof(BlockColumnMask) * 8;
+
+    // Determines if two blocks are of the same mesheable kind.
+    const MeshComparator are_same_instanceable{};
+
+    /*
+     * Columns are indexed by y + z * CHUNK_LENGTH, such that
+     * the bit x of column row is at block index
+     * x + row * CHUNK_LENGTH.
+     */
+
+    // One representative block per kind of instanceable block,
+    // along with the columns of the chunk that are of that kind.
+    std::vector<Block>                          kind_representatives;
+    std::vector<std::vector<BlockColumnMask>>   kind_columns;
+    // The kind each distinct block has been found to be, -1
+    // for blocks that are not instanceable.
+    std::vector<std::pair<BlockID, i32>>        kind_cache;
+
+    auto kind_of = [&](const Block& block, BlockChunkPosition position, Chunk* owner) -> i32 {
+        for (auto& [id, kind] : kind_cache) {
+            if (id == block.id) return kind;
+        }
+
+        i32 kind = -1;
+        if (are_same_instanceable(&block, &block, position, owner)) {
+            for (size_t k = 0; k < kind_representatives.size(); ++k) {
+                if (are_same_instanceable(&kind_representatives[k], &block, position, owner)) {
+                    kind = static_cast<i32>(k);
+                    break;
+                }
+            }
+
+            if (kind < 0) {
+                kind = static_cast<i32>(kind_representatives.size());
+
+                kind_representatives.emplace_back(block);
+                kind_columns.emplace_back(CHUNK_AREA, BlockColumnMask{0});
+            }
+        }
+
+        kind_cache.emplace_back(block.id, kind);
+
+        return kind;
+    };
+
+    /**************************\
+     * Build Column Bitmasks  *
+    \**************************/
+
+    Chunk* raw_chunk_ptr = chunk.get();
+
+    Block* blocks = new Block[CHUNK_VOLUME];
+    {
+        std::shared_lock block_lock(chunk->blocks_mutex);
+
+        chunk->blocks.unpack(blocks);
+    }
+
+    const ui32 cell_length = lod_cell_length(chunk->render_state.load(std::memory_order_acquire));
+
+    if (cell_length > 1) {
+        /**************************\
+         * Downsample For LOD     *
+        \**************************/
+
+        // Each cell of blocks becomes the most common instanceable
+        // block in it if at least half of it is instanceable, and
+        // otherwise the most common block in it that is not. The
+        // cells are then meshed as blocks would be, and so each
+        // face of a cell is covered by no more than one quad or
+        // cuboid.
+        std::vector<std::pair<Block, ui32>> counts;
+
+        for (ui32 cell_z = 0; cell_z < CHUNK_LENGTH; cell_z += cell_length) {
+            for (ui32 cell_y = 0; cell_y < CHUNK_LENGTH; cell_y += cell_length) {
+                for (ui32 cell_x = 0; cell_x < CHUNK_LENGTH; cell_x += cell_length) {
+                    const ui32 end_x = std::min(cell_x + cell_length, static_cast<ui32>(CHUNK_LENGTH));
+                    const ui32 end_y = std::min(cell_y + cell_length, static_cast<ui32>(CHUNK_LENGTH));
+                    const ui32 end_z = std::min(cell_z + cell_length, static_cast<ui32>(CHUNK_LENGTH));
+
+                    counts.clear();
+                    for (ui32 z = cell_z; z < end_z; ++z) {
+                        for (ui32 y = cell_y; y < end_y; ++y) {
+                            for (ui32 x = cell_x; x < end_x; ++x) {
+                                const Block& block = blocks[x + y * CHUNK_LENGTH + z * CHUNK_AREA];
+
+                                auto it = std::find_if(counts.begin(), counts.end(), [&](const auto& count) {
+                                    return count.first.id == block.id;
+                                });
+
+                                if (it == counts.end()) {
+                                    counts.emplace_back(block, 1);
+                                } else {
+                                    ++it->second;
+                                }
+                            }
+                        }
+                    }
+
+                    const BlockChunkPosition cell_position{cell_x, cell_y, cell_z};
+
+                    ui32 instanceable_total = 0, cell_total = 0;
+                    const std::pair<Block, ui32>* most_instanceable = nullptr;
+                    const std::pair<Block, ui32>* most_other        = nullptr;
+                    for (const auto& count : counts) {
+                        cell_total += count.second;
+
+                        if (kind_of(count.first, cell_position, raw_chunk_ptr) >= 0) {
+                            instanceable_total += count.second;
+
+                            if (!most_instanceable || count.second > most_instanceable->second)
+                                most_instanceable = &count;
+                        } else if (!most_other || count.second > most_other->second) {
+                            most_other = &count;
+                        }
+                    }
+
+                    const Block cell_block = (2 * instanceable_total >= cell_total && most_instanceable) ?
+                                                most_instanceable->first : most_other->first;
+
+                    for (ui32 z = cell_z; z < end_z; ++z) {
+                        for (ui32 y = cell_y; y < end_y; ++y) {
+                            std::fill_n(&blocks[cell_x + y * CHUNK_LENGTH + z * CHUNK_AREA], end_x - cell_x, cell_block);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<BlockColumnMask> occupied(CHUNK_AREA, BlockColumnMask{0});
+
+    bool    have_last_block = false;
+    BlockID last_block_id   = 0;
+    i32     last_kind       = -1;
+
+    for (BlockIndex row = 0; row < CHUNK_AREA; ++row) {
+        for (BlockIndex x = 0; x < CHUNK_LENGTH; ++x) {
+            BlockIndex i = x + row * CHUNK_LENGTH;
+
+            // Runs of identical blocks are by far the common case.
+            if (!have_last_block || blocks[i].id != last_block_id) {
+                last_kind       = kind_of(blocks[i], block_chunk_position(i), raw_chunk_ptr);
+                last_block_id   = blocks[i].id;
+                have_last_block = true;
+            }
+
+            if (last_kind < 0) continue;
+
+            BlockColumnMask bit = BlockColumnMask{1} << x;
+
+            kind_columns[static_cast<size_t>(last_kind)][row] |= bit;
+            occupied[row]                                     |= bit;
+        }
+    }
+
+    delete[] blocks;
+
+    // Meshing may have been superseded while we were building
+    // bitmasks, in which case the rest is wasted effort.
+    if (is_cancelled()) {
+        chunk->mesh_task_active.store(false, std::memory_order_release);
+        return;
+    }
+
+    /*************************\
+     * Read Neighbour Faces  *
+    \*************************/
+
+    // Occupancy of the layer of each neighbour that touches
+    // this chunk. Absent neighbours are treated as empty.
+    //   Left and right are indexed by row and hold just a
+    //   single bit, the others are columns along x indexed
+    //   by z for bottom and top, and by y for front and back.
+    std::vector<BlockColumnMask> left_face  (CHUNK_AREA,   BlockColumnMask{0});
+    std::vector<BlockColumnMask> right_face (CHUNK_AREA,   BlockColumnMask{0});
+    std::vector<BlockColumnMask> bottom_face(CHUNK_LENGTH, BlockColumnMask{0});
+    std::vector<BlockColumnMask> top_face   (CHUNK_LENGTH, BlockColumnMask{0});
+    std::vector<BlockColumnMask> front_face (CHUNK_LENGTH, BlockColumnMask{0});
+    std::vector<BlockColumnMask> back_face  (CHUNK_LENGTH, BlockColumnMask{0});
+
+    // Each neighbour is locked just the once, to read the
+    // whole of its touching layer.
+    auto is_occupied = [&](Chunk* neighbour, BlockChunkPosition position) {
+        Block block = neighbour->blocks[block_index(position)];
+
+        return kind_of(block, position, neighbour) >= 0;
+    };
+
+    // Chunks at a lower level of detail need not line up with
+    // their neighbours, so draw all faces on their border rather
+    // than risk leaving cracks between them.
+    if (cell_length == 1) {
+        // LEFT
+        if (Chunk* neighbour = linked_chunk(chunk->neighbours.one.left); neighbour != nullptr) {
+            std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+            for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                    if (is_occupied(neighbour, {CHUNK_LENGTH - 1, y, z}))
+                        left_face[y + z * CHUNK_LENGTH] = BlockColumnMask{1};
+                }
+            }
+        }
+
+        // RIGHT
+        if (Chunk* neighbour = linked_chunk(chunk->neighbours.one.right); neighbour != nullptr) {
+            std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+            for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                    if (is_occupied(neighbour, {0, y, z}))
+                        right_face[y + z * CHUNK_LENGTH] = BlockColumnMask{1} << (CHUNK_LENGTH - 1);
+                }
+            }
+        }
+
+        // BOTTOM
+        if (Chunk* neighbour = linked_chunk(chunk->neighbours.one.bottom); neighbour != nullptr) {
+            std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+            for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                for (ui32 x = 0; x < CHUNK_LENGTH; ++x) {
+                    if (is_occupied(neighbour, {x, CHUNK_LENGTH - 1, z}))
+                        bottom_face[z] |= BlockColumnMask{1} << x;
+                }
+            }
+        }
+
+        // TOP
+        if (Chunk* neighbour = linked_chunk(chunk->neighbours.one.top); neighbour != nullptr) {
+            std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+            for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                for (ui32 x = 0; x < CHUNK_LENGTH; ++x) {
+                    if (is_occupied(neighbour, {x, 0, z}))
+                        top_face[z] |= BlockColumnMask{1} << x;
+                }
+            }
+        }
+
+        // FRONT
+        if (Chunk* neighbour = linked_chunk(chunk->neighbours.one.front); neighbour != nullptr) {
+            std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+            for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                for (ui32 x = 0; x < CHUNK_LENGTH; ++x) {
+                    if (is_occupied(neighbour, {x, y, CHUNK_LENGTH - 1}))
+                        front_face[y] |= BlockColumnMask{1} << x;
+                }
+            }
+        }
+
+        // BACK
+        if (Chunk* neighbour = linked_chunk(chunk->neighbours.one.back); neighbour != nullptr) {
+            std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+            for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                for (ui32 x = 0; x < CHUNK_LENGTH; ++x) {
+                    if (is_occupied(neighbour, {x, y, 0}))
+                        back_face[y] |= BlockColumnMask{1} << x;
+                }
+            }
+        }
+    }
+
+    // Last chance to bail before the chunk's current mesh
+    // is replaced.
+    if (is_cancelled()) {
+        chunk->mesh_task_active.store(false, std::memory_order_release);
+        return;
+    }
+
+    if constexpr (MeshOutput == ChunkMeshOutput::FACE_QUADS) {
+        /**************************\
+         * Determine Visibility   *
+        \**************************/
+
+        // For each face, in the order of BlockFace, bit x of row
+        // is set if the face of the block at x looking out in
+        // that direction is not hidden by an instanceable block.
+        std::array<std::vector<BlockColumnMask>, 6> visible;
+        for (auto& faces : visible) faces.resize(CHUNK_AREA, BlockColumnMask{0});
+
+        for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+            for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                BlockIndex row = y + z * CHUNK_LENGTH;
+
+                BlockColumnMask columns = occupied[row];
+                if (columns == 0) continue;
+
+                visible[0][row] = columns & ~((columns << 1) | left_face[row]);
+                visible[1][row] = columns & ~((columns >> 1) | right_face[row]);
+                visible[2][row] = columns & ~(y > 0                ? occupied[row - 1]            : bottom_face[z]);
+                visible[3][row] = columns & ~(y < CHUNK_LENGTH - 1 ? occupied[row + 1]            : top_face[z]);
+                visible[4][row] = columns & ~(z > 0                ? occupied[row - CHUNK_LENGTH] : front_face[y]);
+                visible[5][row] = columns & ~(z < CHUNK_LENGTH - 1 ? occupied[row + CHUNK_LENGTH] : back_face[y]);
+            }
+        }
+
+        /*****************\
+         * Merge Quads   *
+        \*****************/
+
+        chunk->instance.generate_quad_buffer();
+
+        std::unique_lock<std::shared_mutex> instance_lock;
+        auto& instance = chunk->instance.get(instance_lock);
+
+        // Greedily covers the set bits of a plane of CHUNK_LENGTH
+        // masks with rectangles, extending runs of set bits (along
+        // u) across successive masks (along v). The plane is
+        // cleared as it is covered.
+        auto merge_plane = [&](BlockColumnMask* plane, auto&& add_quad) {
+            for (ui32 v = 0; v < CHUNK_LENGTH; ++v) {
+                while (plane[v] != 0) {
+                    ui32 start_u = static_cast<ui32>(std::countr_zero(plane[v]));
+
+                    BlockColumnMask shifted = plane[v] >> start_u;
+                    ui32 length_u = static_cast<ui32>(std::countr_one(shifted));
+
+                    BlockColumnMask run = length_u >= COLUMN_BITS ?
+                                            ~BlockColumnMask{0}
+                                                : ((BlockColumnMask{1} << length_u) - 1);
+                    run <<= start_u;
+
+                    ui32 end_v = v + 1;
+                    while (end_v < CHUNK_LENGTH && (plane[end_v] & run) == run)
+                        ++end_v;
+
+                    for (ui32 scan_v = v; scan_v < end_v; ++scan_v)
+                        plane[scan_v] &= ~run;
+
+                    add_quad(start_u, v, length_u, end_v - v);
+                }
+            }
+        };
+
+        // Masks along x of a single plane of fixed y or z.
+        std::array<BlockColumnMask, CHUNK_LENGTH> plane;
+        // Masks along y of every plane of fixed x, indexed by
+        // z + x * CHUNK_LENGTH.
+        std::vector<BlockColumnMask> transposed(CHUNK_AREA);
+
+        for (size_t k = 0; k < kind_columns.size(); ++k) {
+            const auto&   columns  = kind_columns[k];
+            const BlockID block_id = kind_representatives[k].id;
+
+            // LEFT & RIGHT
+            for (ui8 face_idx = 0; face_idx < 2; ++face_idx) {
+                const BlockFace face = static_cast<BlockFace>(face_idx);
+
+                std::fill(transposed.begin(), transposed.end(), BlockColumnMask{0});
+
+                for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                    for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                        BlockIndex row = y + z * CHUNK_LENGTH;
+
+                        BlockColumnMask faces = visible[face_idx][row] & columns[row];
+                        while (faces != 0) {
+                            ui32 x = static_cast<ui32>(std::countr_zero(faces));
+                            faces &= faces - 1;
+
+                            transposed[z + x * CHUNK_LENGTH] |= BlockColumnMask{1} << y;
+                        }
+                    }
+                }
+
+                for (ui32 x = 0; x < CHUNK_LENGTH; ++x) {
+                    merge_plane(&transposed[x * CHUNK_LENGTH], [&](ui32 y, ui32 z, ui32 height, ui32 depth) {
+                        instance.quads[instance.quad_count++] = ChunkQuadData::pack(
+                            BlockChunkPosition{x, y, z}, height, depth, face, block_id
+                        );
+                    });
+                }
+            }
+
+            // BOTTOM & TOP
+            for (ui8 face_idx = 2; face_idx < 4; ++face_idx) {
+                const BlockFace face = static_cast<BlockFace>(face_idx);
+
+                for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                    for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                        BlockIndex row = y + z * CHUNK_LENGTH;
+
+                        plane[z] = visible[face_idx][row] & columns[row];
+                    }
+
+                    merge_plane(plane.data(), [&](ui32 x, ui32 z, ui32 width, ui32 depth) {
+                        instance.quads[instance.quad_count++] = ChunkQuadData::pack(
+                            BlockChunkPosition{x, y, z}, width, depth, face, block_id
+                        );
+                    });
+                }
+            }
+
+            // FRONT & BACK
+            for (ui8 face_idx = 4; face_idx < 6; ++face_idx) {
+                const BlockFace face = static_cast<BlockFace>(face_idx);
+
+                for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                    for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                        BlockIndex row = y + z * CHUNK_LENGTH;
+
+                        plane[y] = visible[face_idx][row] & columns[row];
+                    }
+
+                    merge_plane(plane.data(), [&](ui32 x, ui32 y, ui32 width, ui32 height) {
+                        instance.quads[instance.quad_count++] = ChunkQuadData::pack(
+                            BlockChunkPosition{x, y, z}, width, height, face, block_id
+                        );
+                    });
+                }
+            }
+        }
+
+        instance_lock.unlock();
+    }
+
+    if constexpr (MeshOutput == ChunkMeshOutput::CUBOID_INSTANCES) {
+        /**************************\
+         * Determine Visibility   *
+        \**************************/
+
+        const BlockColumnMask full_column = ~BlockColumnMask{0} >> (COLUMN_BITS - CHUNK_LENGTH);
+
+        // A block is exposed if any of its six faces touches a
+        // block that is not instanceable.
+        std::vector<BlockColumnMask> exposed(CHUNK_AREA, BlockColumnMask{0});
+
+        for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+            for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                BlockIndex row = y + z * CHUNK_LENGTH;
+
+                BlockColumnMask columns = occupied[row];
+                if (columns == 0) continue;
+
+                // Each of these has bit x set if the block adjacent
+                // to x in the given direction is occupied.
+                BlockColumnMask left   = ((columns << 1) | left_face[row])  & full_column;
+                BlockColumnMask right  =  (columns >> 1) | right_face[row];
+                BlockColumnMask bottom = y > 0                ? occupied[row - 1]            : bottom_face[z];
+                BlockColumnMask top    = y < CHUNK_LENGTH - 1 ? occupied[row + 1]            : top_face[z];
+                BlockColumnMask front  = z > 0                ? occupied[row - CHUNK_LENGTH] : front_face[y];
+                BlockColumnMask back   = z < CHUNK_LENGTH - 1 ? occupied[row + CHUNK_LENGTH] : back_face[y];
+
+                exposed[row] = columns & ~(left & right & bottom & top & front & back);
+            }
+        }
+
+        /*******************\
+         * Merge Cuboids   *
+        \*******************/
+
+        chunk->instance.generate_buffer();
+
+        std::unique_lock<std::shared_mutex> instance_lock;
+        auto& instance = chunk->instance.get(instance_lock);
+
+        // Blocks of the kind not yet covered by a cuboid, and
+        // those among them that must still be covered. Cuboids
+        // are free to extend over hidden blocks, but need never
+        // start from one.
+        std::vector<BlockColumnMask> available(CHUNK_AREA);
+        std::vector<BlockColumnMask> remaining(CHUNK_AREA);
+
+        for (auto& columns : kind_columns) {
+            for (BlockIndex row = 0; row < CHUNK_AREA; ++row) {
+                available[row] = columns[row];
+                remaining[row] = columns[row] & exposed[row];
+            }
+
+            for (ui32 z = 0; z < CHUNK_LENGTH; ++z) {
+                for (ui32 y = 0; y < CHUNK_LENGTH; ++y) {
+                    BlockIndex row = y + z * CHUNK_LENGTH;
+
+                    while (remaining[row] != 0) {
+                        // Scan X - 1D
+                        ui32 start_x = static_cast<ui32>(std::countr_zero(remaining[row]));
+
+                        BlockColumnMask shifted = available[row] >> start_x;
+                        ui32 length_x = static_cast<ui32>(std::countr_one(shifted));
+
+                        BlockColumnMask run = length_x >= COLUMN_BITS ?
+                                                ~BlockColumnMask{0}
+                                                    : ((BlockColumnMask{1} << length_x) - 1);
+                        run <<= start_x;
+
+                        // Scan Z - 2D
+                        ui32 end_z = z + 1;
+                        while (end_z < CHUNK_LENGTH && (available[y + end_z * CHUNK_LENGTH] & run) == run)
+                            ++end_z;
+
+                        // Scan Y - 3D
+                        ui32 end_y = y + 1;
+                        for (; end_y < CHUNK_LENGTH; ++end_y) {
+                            bool fits = true;
+                            for (ui32 scan_z = z; scan_z < end_z; ++scan_z) {
+                                if ((available[end_y + scan_z * CHUNK_LENGTH] & run) != run) {
+                                    fits = false;
+                                    break;
+                                }
+                            }
+
+                            if (!fits) break;
+                        }
+
+                        // Mark cuboid as covered.
+                        for (ui32 scan_z = z; scan_z < end_z; ++scan_z) {
+                            for (ui32 scan_y = y; scan_y < end_y; ++scan_y) {
+                                available[scan_y + scan_z * CHUNK_LENGTH] &= ~run;
+                                remaining[scan_y + scan_z * CHUNK_LENGTH] &= ~run;
+                            }
+                        }
+
+                        // Create Instance
+                        BlockWorldPosition start_instance = block_world_position(
+                            chunk->position, BlockChunkPosition{start_x, y, z}
+                        );
+
+                        instance.data[instance.count++] = ChunkInstanceData{
+                            f32v3(start_instance),
+                            f32v3(
+                                static_cast<f32>(length_x),
+                                static_cast<f32>(end_y - y),
+                                static_cast<f32>(end_z - z)
+                            )
+                        };
+                    }
+                }
+            }
+        }
+
+        instance_lock.unlock();
+    }
+
+    chunk->state.store(ChunkState::MESHED, std::memory_order_release);
+
+    chunk->mesh_task_active.store(false, std::memory_order_release);
+
+    chunk->mesh_empty.store(false, std::memory_order_release);
+
+    chunk->on_mesh_change();
+
+    // TODO(Matthew): Set next task if chunk unload is false? Or else set that
+    //                between this task and next, but would need adjusting
+    //                workflow.
+    chunk->pending_task.store(ChunkTaskKind::NONE, std::memory_order_release);
+}
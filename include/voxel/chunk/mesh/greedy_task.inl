@@ -12,6 +12,10 @@ void hvox::ChunkGreedyMeshTask<MeshComparator>::execute(ChunkLoadThreadState*, C
 
     chunk->mesh_task_active.store(true, std::memory_order_release);
 
+    // Chunks with nothing to mesh, such as those of only air,
+    // skip the mesh pass entirely.
+    if (complete_if_empty_mesh(chunk.get())) return;
+
     // TODO(Matthew): Better guess work should be possible and expand only when needed.
     //                  Maybe in addition to managing how all chunk's transformations are
     //                  stored on GPU, ChunkGrid-level should also manage this data?
@@ -23,7 +27,7 @@ void hvox::ChunkGreedyMeshTask<MeshComparator>::execute(ChunkLoadThreadState*, C
 
     std::shared_lock block_lock(chunk->blocks_mutex);
 
-    Block* blocks = chunk->blocks;
+    const ChunkBlockStorage& blocks = chunk->blocks;
 
     std::queue<BlockChunkPosition> queued_for_visit;
 
@@ -34,7 +38,7 @@ void hvox::ChunkGreedyMeshTask<MeshComparator>::execute(ChunkLoadThreadState*, C
     std::unique_lock<std::shared_mutex> instance_lock;
     auto& instance = chunk->instance.get(instance_lock);
 
-    const Block*        source = &blocks[0];
+    Block               source = blocks[0];
     BlockChunkPosition  start  = BlockChunkPosition{0};
     BlockChunkPosition  end    = BlockChunkPosition{0};
     BlockChunkPosition  target_pos;
@@ -74,7 +78,7 @@ void hvox::ChunkGreedyMeshTask<MeshComparator>::execute(ChunkLoadThreadState*, C
     bool blocks_to_consider = true;
     while (blocks_to_consider) {
 process_new_source:
-        bool found_instanceable = are_same_instanceable(source, source, {}, raw_chunk_ptr);
+        bool found_instanceable = are_same_instanceable(&source, &source, {}, raw_chunk_ptr);
 
         /***************\
          * Scan X - 1D *
@@ -84,12 +88,12 @@ process_new_source:
         for (; target_pos.x < CHUNK_LENGTH; ++target_pos.x) {
             auto target_idx = block_index(target_pos);
 
-            const Block* target = &blocks[target_idx];
+            const Block target = blocks[target_idx];
             // We are scanning for a new instanceable source block.
             if (!found_instanceable) {
                 // Found a instanceable source block that hasn't already
                 // been visited.
-                if (are_same_instanceable(target, target, target_pos, raw_chunk_ptr)
+                if (are_same_instanceable(&target, &target, target_pos, raw_chunk_ptr)
                         && !visited[target_idx]) {
                     add_border_blocks_to_queue(start, target_pos);
 
@@ -106,7 +110,7 @@ process_new_source:
                 }
             // We are scanning for the extent of an instanceable source block.
             } else {
-                if (!are_same_instanceable(source, target, target_pos, raw_chunk_ptr)
+                if (!are_same_instanceable(&source, &target, target_pos, raw_chunk_ptr)
                         || visited[target_idx]) {
                     end.x = target_pos.x - 1;
 
@@ -145,12 +149,12 @@ process_new_source:
             for (target_pos.x = start.x; target_pos.x <= end.x; ++target_pos.x) {
                 auto target_idx = block_index(target_pos);
 
-                const Block* target = &blocks[target_idx];
+                const Block target = blocks[target_idx];
                 // We are scanning for a new instanceable source block.
                 if (!found_instanceable) {
                     // Found a instanceable source block that hasn't already
                     // been visited.
-                    if (are_same_instanceable(target, target, target_pos, raw_chunk_ptr)
+                    if (are_same_instanceable(&target, &target, target_pos, raw_chunk_ptr)
                             && !visited[target_idx]) {
                         add_border_blocks_to_queue(start, target_pos);
 
@@ -166,7 +170,7 @@ process_new_source:
                         continue;
                     }
                 // We are scanning for the extent of an instanceable source block.
-                } else if (!are_same_instanceable(source, target, target_pos, raw_chunk_ptr)
+                } else if (!are_same_instanceable(&source, &target, target_pos, raw_chunk_ptr)
                                 || visited[target_idx]) {
                     end.z = target_pos.z - 1;
 
@@ -209,12 +213,12 @@ process_new_source:
                 for (target_pos.x = start.x; target_pos.x <= end.x; ++target_pos.x) {
                     auto target_idx = block_index(target_pos);
 
-                    const Block* target = &blocks[target_idx];
+                    const Block target = blocks[target_idx];
                     // We are scanning for a new instanceable source block.
                     if (!found_instanceable) {
                         // Found a instanceable source block that hasn't already
                         // been visited.
-                        if (are_same_instanceable(target, target, target_pos, raw_chunk_ptr)
+                        if (are_same_instanceable(&target, &target, target_pos, raw_chunk_ptr)
                                 && !visited[target_idx]) {
                             add_border_blocks_to_queue(start, target_pos);
 
@@ -230,7 +234,7 @@ process_new_source:
                             continue;
                         }
                     // We are scanning for the extent of an instanceable source block.
-                    } else if (!are_same_instanceable(source, target, target_pos, raw_chunk_ptr)
+                    } else if (!are_same_instanceable(&source, &target, target_pos, raw_chunk_ptr)
                                     || visited[target_idx]) {
                         end.y = target_pos.y - 1;
 
@@ -288,7 +292,7 @@ process_new_source:
         do {
             start  = queued_for_visit.front();
             end    = start;
-            source = &blocks[block_index(start)];
+            source = blocks[block_index(start)];
 
             queued_for_visit.pop();
 
@@ -312,6 +316,8 @@ process_new_source:
 
     chunk->mesh_task_active.store(false, std::memory_order_release);
 
+    chunk->mesh_empty.store(false, std::memory_order_release);
+
     chunk->on_mesh_change();
 
     // TODO(Matthew): Set next task if chunk unload is false? Or else set that
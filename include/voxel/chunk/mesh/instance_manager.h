@@ -2,40 +2,122 @@
 #define __hemlock_voxel_chunk_mesh_instance_manager_h
 
 #include "voxel/block.hpp"
+#include "voxel/coordinate_system.h"
 #include "voxel/chunk/constants.hpp"
+#include "voxel/chunk/mesh/staging_buffer.h"
 
 namespace hemlock {
     namespace voxel {
+        static_assert(CHUNK_LENGTH <= 64, "Packed quads support chunks at most 64 blocks long.");
+
+        /**
+         * @brief The kinds of mesh a chunk's mesh task can
+         * output, and that the chunk renderer can draw.
+         */
+        enum class ChunkMeshOutput : ui8 {
+            CUBOID_INSTANCES    = 0,
+            FACE_QUADS          = 1
+        };
+
+        /**
+         * @brief The direction a block face looks out in.
+         */
+        enum class BlockFace : ui8 {
+            LEFT    = 0,
+            RIGHT   = 1,
+            BOTTOM  = 2,
+            TOP     = 3,
+            FRONT   = 4,
+            BACK    = 5
+        };
+
         struct ChunkInstanceData {
             f32v3 translation, scaling;
         };
+
+        /**
+         * @brief A single rectangle of block faces, packed into
+         * two 32-bit words.
+         *
+         * The first word holds, from the lowest bits up, the
+         * chunk-local x, y and z of the block at the quad's
+         * minimum corner and then the quad's width and height
+         * less one, six bits each. The second word holds the
+         * face in its lowest three bits and the lowest 29 bits
+         * of the block's ID above that.
+         *
+         * Width and height are measured along y and z for left
+         * and right faces, x and z for bottom and top faces, and
+         * x and y for front and back faces.
+         */
+        struct ChunkQuadData {
+            ui32 position_and_size;
+            ui32 face_and_block;
+
+            static ChunkQuadData pack(BlockChunkPosition position, ui32 width, ui32 height, BlockFace face, BlockID block_id) {
+                return ChunkQuadData{
+                    static_cast<ui32>(position.x)
+                        | (static_cast<ui32>(position.y) << 6)
+                        | (static_cast<ui32>(position.z) << 12)
+                        | ((width  - 1) << 18)
+                        | ((height - 1) << 24),
+                    static_cast<ui32>(face)
+                        | (static_cast<ui32>(block_id & 0x1fffffff) << 3)
+                };
+            }
+        };
+
         struct ChunkInstance {
             ChunkInstanceData*  data;
             ui32                count;
+            ChunkQuadData*      quads;
+            ui32                quad_count;
         };
 
         // TODO(Matthew): Maybe we want to make this even smaller pages and expand on demand.
         using ChunkInstanceDataPager = hmem::Pager<ChunkInstanceData, CHUNK_VOLUME / 2, 3>;
-        using ChunkBlockPager        = hmem::Pager<            Block, CHUNK_VOLUME    , 3>;
+        // NOTE(Matthew): Worst case is a checkerboard of blocks, every
+        //                one of the half of the chunk that is filled
+        //                then showing all six faces.
+        using ChunkQuadDataPager     = hmem::Pager<ChunkQuadData, CHUNK_VOLUME * 3, 3>;
 
+        /**
+         * @brief Manages the buffers a chunk's mesh is written
+         * into. Buffers are taken from the staging buffer when
+         * one is given and has a block free, so that the mesh
+         * need not be copied again on upload, and otherwise
+         * from the pagers.
+         */
         class ChunkInstanceManager {
         public:
             ChunkInstanceManager();
             ~ChunkInstanceManager() { /* Empty. */ }
 
-            void init(hmem::Handle<ChunkInstanceDataPager> data_pager);
+            void init( hmem::Handle<ChunkInstanceDataPager> data_pager,
+                           hmem::Handle<ChunkQuadDataPager> quad_pager,
+                           hmem::Handle<ChunkStagingBuffer> staging_buffer = nullptr );
             void dispose();
 
                   ChunkInstance& get(std::unique_lock<std::shared_mutex>& lock);
             const ChunkInstance& get(std::shared_lock<std::shared_mutex>& lock);
 
             void generate_buffer();
+            void generate_quad_buffer();
             void free_buffer();
         protected:
+            /**
+             * @brief Releases the buffers held, to the staging
+             * buffer or pagers they came from.
+             */
+            void release_buffers();
+
             hmem::Handle<ChunkInstanceDataPager> m_data_pager;
+            hmem::Handle<ChunkQuadDataPager>     m_quad_pager;
+            hmem::Handle<ChunkStagingBuffer>     m_staging_buffer;
 
             std::shared_mutex   m_mutex;
             ChunkInstance       m_instance;
+            bool                m_data_staged, m_quads_staged;
         };
     }
 }
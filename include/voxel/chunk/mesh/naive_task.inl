@@ -41,33 +41,21 @@ static inline hvox::BlockIndex index_at_back_face(hvox::BlockIndex index) {
 }
 
 template <hvox::ChunkMeshComparator MeshComparator>
-void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* state, ChunkTaskQueue* task_queue) {
+void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState*, ChunkTaskQueue*) {
     auto chunk = m_chunk.lock();
 
     if (chunk == nullptr) return;
 
     chunk->mesh_task_active.store(true, std::memory_order_release);
 
-    {
-        auto chunk_grid = m_chunk_grid.lock();
+    // Chunks with nothing to mesh, such as those of only air,
+    // skip the mesh pass entirely.
+    if (complete_if_empty_mesh(chunk.get())) return;
 
-        if (chunk_grid == nullptr) return;
-
-        // Only execute if all preloaded neighbouring chunks have at least been generated.
-        auto [ _, neighbours_in_required_state ] =
-                chunk_grid->query_all_neighbour_states(chunk, ChunkState::GENERATED);
-
-        if (!neighbours_in_required_state) {
-            // Mark as no longer engaging in this meshing task.
-            chunk->mesh_task_active.store(false, std::memory_order_release);
-            // Put copy of this mesh task back onto the load task queue.
-            ChunkNaiveMeshTask<MeshComparator>* mesh_task = new ChunkNaiveMeshTask<MeshComparator>();
-            mesh_task->set_state(m_chunk, m_chunk_grid);
-            task_queue->enqueue(state->producer_token, { mesh_task, true });
-            chunk->pending_task.store(ChunkTaskKind::MESH, std::memory_order_release);
-            return;
-        }
-    }
+    // NOTE(Matthew): The grid only queues mesh tasks for chunks
+    //                once all of their neighbours it holds have
+    //                been generated, so there is no need to wait
+    //                on them here.
 
     // TODO(Matthew): Better guess work should be possible and expand only when needed.
     //                  Maybe in addition to managing how all chunk's transformations are
@@ -93,6 +81,15 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
 
     Chunk* raw_chunk_ptr = chunk.get();
 
+    // Neighbours are found through their slots just the once,
+    // rather than for each block on the faces of the chunk.
+    Chunk* left_neighbour   = linked_chunk(chunk->neighbours.one.left);
+    Chunk* right_neighbour  = linked_chunk(chunk->neighbours.one.right);
+    Chunk* bottom_neighbour = linked_chunk(chunk->neighbours.one.bottom);
+    Chunk* top_neighbour    = linked_chunk(chunk->neighbours.one.top);
+    Chunk* front_neighbour  = linked_chunk(chunk->neighbours.one.front);
+    Chunk* back_neighbour   = linked_chunk(chunk->neighbours.one.back);
+
     std::shared_lock block_lock(chunk->blocks_mutex);
     std::shared_lock<std::shared_mutex> neighbour_lock;
 
@@ -100,26 +97,31 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
     // TODO(Matthew): Checking block is NULL_BLOCK is wrong check really, we will have transparent blocks
     //                e.g. air, to account for too.
     for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
-        Block& voxel = chunk->blocks[i];
+        Block voxel = chunk->blocks[i];
         if (voxel != NULL_BLOCK) {
             BlockWorldPosition block_position = block_world_position(chunk->position, i);
 
-            hmem::Handle<Chunk> neighbour;
+            Chunk* neighbour;
 
             // Check its neighbours, to decide whether to add its quads.
             // LEFT
             if (is_at_left_face(i)) {
                 // Get corresponding neighbour index in neighbour chunk and check.
                 BlockIndex j = index_at_right_face(i);
-                neighbour = chunk->neighbours.one.left.lock();
+                neighbour = left_neighbour;
+                if (neighbour == nullptr) {
+                    add_block(block_position);
+                    continue;
+                }
                 neighbour_lock = std::shared_lock(neighbour->blocks_mutex);
-                if (neighbour == nullptr || neighbour->blocks[j] == NULL_BLOCK) {
+                if (neighbour->blocks[j] == NULL_BLOCK) {
                     add_block(block_position);
                     continue;
                 }
             } else {
                 // Get corresponding neighbour index in this chunk and check.
-                if (meshable(&chunk->blocks[i - 1], &chunk->blocks[i - 1], block_chunk_position(i), raw_chunk_ptr)) {
+                Block adjacent = chunk->blocks[i - 1];
+                if (meshable(&adjacent, &adjacent, block_chunk_position(i), raw_chunk_ptr)) {
                     add_block(block_position);
                     continue;
                 }
@@ -129,15 +131,20 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
             if (is_at_right_face(i)) {
                 // Get corresponding neighbour index in neighbour chunk and check.
                 BlockIndex j = index_at_left_face(i);
-                neighbour = chunk->neighbours.one.right.lock();
+                neighbour = right_neighbour;
+                if (neighbour == nullptr) {
+                    add_block(block_position);
+                    continue;
+                }
                 neighbour_lock = std::shared_lock(neighbour->blocks_mutex);
-                if (neighbour == nullptr || neighbour->blocks[j] == NULL_BLOCK) {
+                if (neighbour->blocks[j] == NULL_BLOCK) {
                     add_block(block_position);
                     continue;
                 }
             } else {
                 // Get corresponding neighbour index in this chunk and check.
-                if (meshable(&chunk->blocks[i + 1], &chunk->blocks[i + 1], block_chunk_position(i), raw_chunk_ptr)) {
+                Block adjacent = chunk->blocks[i + 1];
+                if (meshable(&adjacent, &adjacent, block_chunk_position(i), raw_chunk_ptr)) {
                     add_block(block_position);
                     continue;
                 }
@@ -147,15 +154,20 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
             if (is_at_bottom_face(i)) {
                 // Get corresponding neighbour index in neighbour chunk and check.
                 BlockIndex j = index_at_top_face(i);
-                neighbour = chunk->neighbours.one.bottom.lock();
+                neighbour = bottom_neighbour;
+                if (neighbour == nullptr) {
+                    add_block(block_position);
+                    continue;
+                }
                 neighbour_lock = std::shared_lock(neighbour->blocks_mutex);
-                if (neighbour == nullptr || neighbour->blocks[j] == NULL_BLOCK) {
+                if (neighbour->blocks[j] == NULL_BLOCK) {
                     add_block(block_position);
                     continue;
                 }
             } else {
                 // Get corresponding neighbour index in this chunk and check.
-                if (meshable(&chunk->blocks[i - CHUNK_LENGTH], &chunk->blocks[i - CHUNK_LENGTH], block_chunk_position(i), raw_chunk_ptr)) {
+                Block adjacent = chunk->blocks[i - CHUNK_LENGTH];
+                if (meshable(&adjacent, &adjacent, block_chunk_position(i), raw_chunk_ptr)) {
                     add_block(block_position);
                     continue;
                 }
@@ -165,15 +177,20 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
             if (is_at_top_face(i)) {
                 // Get corresponding neighbour index in neighbour chunk and check.
                 BlockIndex j = index_at_bottom_face(i);
-                neighbour = chunk->neighbours.one.top.lock();
+                neighbour = top_neighbour;
+                if (neighbour == nullptr) {
+                    add_block(block_position);
+                    continue;
+                }
                 neighbour_lock = std::shared_lock(neighbour->blocks_mutex);
-                if (neighbour == nullptr || neighbour->blocks[j] == NULL_BLOCK) {
+                if (neighbour->blocks[j] == NULL_BLOCK) {
                     add_block(block_position);
                     continue;
                 }
             } else {
                 // Get corresponding neighbour index in this chunk and check.
-                if (meshable(&chunk->blocks[i + CHUNK_LENGTH], &chunk->blocks[i + CHUNK_LENGTH], block_chunk_position(i), raw_chunk_ptr)) {
+                Block adjacent = chunk->blocks[i + CHUNK_LENGTH];
+                if (meshable(&adjacent, &adjacent, block_chunk_position(i), raw_chunk_ptr)) {
                     add_block(block_position);
                     continue;
                 }
@@ -183,15 +200,20 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
             if (is_at_front_face(i)) {
                 // Get corresponding neighbour index in neighbour chunk and check.
                 BlockIndex j = index_at_back_face(i);
-                neighbour = chunk->neighbours.one.front.lock();
+                neighbour = front_neighbour;
+                if (neighbour == nullptr) {
+                    add_block(block_position);
+                    continue;
+                }
                 neighbour_lock = std::shared_lock(neighbour->blocks_mutex);
-                if (neighbour == nullptr || neighbour->blocks[j] == NULL_BLOCK) {
+                if (neighbour->blocks[j] == NULL_BLOCK) {
                     add_block(block_position);
                     continue;
                 }
             } else {
                 // Get corresponding neighbour index in this chunk and check.
-                if (meshable(&chunk->blocks[i - (CHUNK_AREA)], &chunk->blocks[i - (CHUNK_AREA)], block_chunk_position(i), raw_chunk_ptr)) {
+                Block adjacent = chunk->blocks[i - (CHUNK_AREA)];
+                if (meshable(&adjacent, &adjacent, block_chunk_position(i), raw_chunk_ptr)) {
                     add_block(block_position);
                     continue;
                 }
@@ -201,15 +223,20 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
             if (is_at_back_face(i)) {
                 // Get corresponding neighbour index in neighbour chunk and check.
                 BlockIndex j = index_at_front_face(i);
-                neighbour = chunk->neighbours.one.back.lock();
+                neighbour = back_neighbour;
+                if (neighbour == nullptr) {
+                    add_block(block_position);
+                    continue;
+                }
                 neighbour_lock = std::shared_lock(neighbour->blocks_mutex);
-                if (neighbour == nullptr || neighbour->blocks[j] == NULL_BLOCK) {
+                if (neighbour->blocks[j] == NULL_BLOCK) {
                     add_block(block_position);
                     continue;
                 }
             } else {
                 // Get corresponding neighbour index in this chunk and check.
-                if (meshable(&chunk->blocks[i + (CHUNK_AREA)], &chunk->blocks[i + (CHUNK_AREA)], block_chunk_position(i), raw_chunk_ptr)) {
+                Block adjacent = chunk->blocks[i + (CHUNK_AREA)];
+                if (meshable(&adjacent, &adjacent, block_chunk_position(i), raw_chunk_ptr)) {
                     add_block(block_position);
                     continue;
                 }
@@ -221,6 +248,8 @@ void hvox::ChunkNaiveMeshTask<MeshComparator>::execute(ChunkLoadThreadState* sta
 
     chunk->mesh_task_active.store(false, std::memory_order_release);
 
+    chunk->mesh_empty.store(false, std::memory_order_release);
+
     chunk->on_mesh_change();
 
     // TODO(Matthew): Set next task if chunk unload is false? Or else set that
@@ -0,0 +1,100 @@
+#ifndef __hemlock_voxel_chunk_mesh_staging_buffer_h
+#define __hemlock_voxel_chunk_mesh_staging_buffer_h
+
+namespace hemlock {
+    namespace voxel {
+        /**
+         * @brief A persistently mapped GPU buffer that chunk
+         * meshes are written straight into by mesh tasks, and
+         * copied out of into render pages on the GPU.
+         *
+         * The buffer is split into blocks, each large enough to
+         * hold the largest mesh of a chunk. Blocks are acquired
+         * and released from any thread, but a released block is
+         * only reused once a fence placed after its release has
+         * signalled, so that it is never overwritten while a copy
+         * out of it may still be pending.
+         *
+         * NOTE: init, dispose and fence make GL calls, and so must
+         *       be called on the thread owning the GL context.
+         */
+        class ChunkStagingBuffer {
+        public:
+            ChunkStagingBuffer();
+            ~ChunkStagingBuffer() { /* Empty. */ }
+
+            /**
+             * @brief Initialises the staging buffer.
+             *
+             * @param block_size The size in bytes of each block.
+             * @param block_count The number of blocks.
+             */
+            void init(size_t block_size, ui32 block_count);
+            /**
+             * @brief Disposes of the staging buffer. Blocks
+             * still acquired are simply dropped on release.
+             */
+            void dispose();
+
+            /**
+             * @brief Acquires a block, if one is free.
+             *
+             * @param size The number of bytes needed.
+             * @return A pointer to the mapped block, or nullptr
+             * if no block is free or blocks are too small.
+             */
+            void* acquire_block(size_t size);
+            /**
+             * @brief Releases a block, making it available
+             * again once GPU work issued before the next call
+             * to fence has completed.
+             *
+             * @param block Pointer to the block, as returned
+             * by acquire_block.
+             */
+            void release_block(const void* block);
+
+            /**
+             * @brief Places a fence after all GPU work issued so
+             * far, covering the blocks released since the last
+             * call, and frees blocks whose fences have signalled.
+             * Intended to be called once each update.
+             */
+            void fence();
+
+            /**
+             * @brief Determines if the pointer is into this
+             * staging buffer.
+             */
+            bool owns(const void* data) const;
+            /**
+             * @brief The offset in bytes into the buffer of the
+             * pointer, which must be owned by the staging buffer.
+             */
+            size_t offset_of(const void* data) const {
+                return static_cast<size_t>(static_cast<const ui8*>(data) - m_mapped);
+            }
+
+            GLuint buffer() const { return m_buffer; }
+        protected:
+            struct FencedBlocks {
+                GLsync              fence;
+                std::vector<ui32>   blocks;
+            };
+
+            GLuint  m_buffer;
+            ui8*    m_mapped;
+            size_t  m_block_size;
+            ui32    m_block_count;
+
+            std::mutex          m_blocks_mutex;
+            std::vector<ui32>   m_free_blocks;
+            std::vector<ui32>   m_released_blocks;
+
+            std::queue<FencedBlocks> m_fenced_blocks;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_chunk_mesh_staging_buffer_h
@@ -0,0 +1,199 @@
+#ifndef __hemlock_voxel_chunk_occupancy_pyramid_h
+#define __hemlock_voxel_chunk_occupancy_pyramid_h
+
+#include "voxel/coordinate_system.h"
+#include "voxel/chunk/constants.hpp"
+
+namespace hemlock {
+    namespace voxel {
+        static_assert(
+            CHUNK_LENGTH > 1 && CHUNK_LENGTH <= 64 && (CHUNK_LENGTH & (CHUNK_LENGTH - 1)) == 0,
+            "Occupancy pyramid supports chunk lengths that are powers of two up to 64."
+        );
+
+        namespace impl {
+            constexpr ui32 occupancy_level_count() {
+                ui32 count = 0;
+                for (ui32 side = CHUNK_LENGTH; side > 0; side >>= 1) ++count;
+
+                return count;
+            }
+
+            constexpr ui32 occupancy_level_side(ui32 level) {
+                return static_cast<ui32>(CHUNK_LENGTH) >> level;
+            }
+
+            /**
+             * @brief Offset in words of the bits of each level of
+             * the occupancy pyramid, the last entry being the total
+             * word count.
+             */
+            constexpr std::array<size_t, occupancy_level_count() + 1> occupancy_level_offsets() {
+                std::array<size_t, occupancy_level_count() + 1> offsets = {};
+                for (ui32 level = 0; level < occupancy_level_count(); ++level) {
+                    const size_t side = occupancy_level_side(level);
+
+                    offsets[level + 1] = offsets[level] + (side * side * side + 63) / 64;
+                }
+
+                return offsets;
+            }
+        }
+
+        /**
+         * @brief Mip pyramid of bitmasks over the occupancy of a
+         * chunk, a block being solid if it is not NULL_BLOCK.
+         *
+         * Level zero holds a bit per block, and each level above
+         * it a bit per 2x2x2 cell of the level below, set if any
+         * of that cell is solid. For a 32^3 chunk the levels are
+         * 32^3, 16^3, 8^3, 4^3, 2^3 and 1 bits, some 4.6KiB, and
+         * so whole 8^3 or 16^3 regions of air can be stepped over
+         * by rays and collision queries with a single test.
+         *
+         * A chunk that is all air or all solid holds no bits at
+         * all, its pyramid is uniform just as its blocks are.
+         *
+         * NOTE: this is not thread-safe, it is owned by the block
+         * storage of a chunk and guarded as it is.
+         */
+        class ChunkOccupancyPyramid {
+        public:
+            static constexpr ui32 LEVEL_COUNT = impl::occupancy_level_count();
+
+            ChunkOccupancyPyramid();
+            ~ChunkOccupancyPyramid();
+
+            ChunkOccupancyPyramid(const ChunkOccupancyPyramid&)            = delete;
+            ChunkOccupancyPyramid& operator=(const ChunkOccupancyPyramid&) = delete;
+
+            /**
+             * @brief Makes the pyramid uniform, releasing its bits.
+             *
+             * @param solid Whether every block is solid.
+             */
+            void fill(bool solid);
+
+            /**
+             * @brief Sets whether the block at the given index is
+             * solid, updating the levels above it.
+             *
+             * @param index The index of the block in the chunk.
+             * @param solid Whether the block is solid.
+             */
+            void set(BlockIndex index, bool solid);
+            /**
+             * @brief Sets whether the block at the given index is
+             * solid, leaving the levels above it stale until the
+             * next call to rebuild. Used to build the pyramid in
+             * bulk.
+             *
+             * @param index The index of the block in the chunk.
+             * @param solid Whether the block is solid.
+             */
+            void set_unpropagated(BlockIndex index, bool solid);
+            /**
+             * @brief Rebuilds every level above the first from the
+             * one below it.
+             */
+            void rebuild();
+
+            /**
+             * @brief Gets whether any block of the cell at the
+             * given level and position within that level is solid.
+             *
+             * @param level The level of the cell, zero being that
+             * of single blocks.
+             * @param x,y,z The position of the cell within the level.
+             */
+            bool is_solid(ui32 level, ui32 x, ui32 y, ui32 z) const;
+            bool is_solid(BlockChunkPosition position) const {
+                return is_solid(0, position.x, position.y, position.z);
+            }
+
+            /**
+             * @brief Finds the highest level at which the cell
+             * holding the given block is empty.
+             *
+             * @param position The position of the block.
+             * @return The level found, each cell of which spans
+             * 2^level blocks along each axis, or -1 if the block
+             * itself is solid.
+             */
+            i32 empty_level(BlockChunkPosition position) const {
+                if (is_uniform()) return m_uniform_solid ? -1 : static_cast<i32>(LEVEL_COUNT - 1);
+
+                /*
+                 * Going up from the block itself, the first solid
+                 * cell met bounds the empty ones below it. Going up
+                 * rather than down keeps the common cases cheap, a
+                 * solid block is found with a single test and air
+                 * near solid blocks with a few.
+                 */
+                i32 level = -1;
+                while (static_cast<ui32>(level + 1) < LEVEL_COUNT && !get_bit(
+                    static_cast<ui32>(level + 1),
+                    static_cast<ui32>(position.x) >> (level + 1),
+                    static_cast<ui32>(position.y) >> (level + 1),
+                    static_cast<ui32>(position.z) >> (level + 1)
+                )) ++level;
+
+                return level;
+            }
+
+            /**
+             * @brief Gets whether any block in the rectangular
+             * cuboid spanning start to end inclusive is solid.
+             *
+             * @param start The near bottom left of the cuboid.
+             * @param end The far top right of the cuboid.
+             */
+            bool any_solid(BlockChunkPosition start, BlockChunkPosition end) const;
+
+            bool is_uniform() const { return m_bits == nullptr; }
+
+            /**
+             * @brief The number of bytes of heap memory held by
+             * the pyramid.
+             */
+            size_t memory_usage() const { return m_bits ? WORD_COUNT * sizeof(ui64) : 0; }
+        protected:
+            static constexpr ui32 side(ui32 level) { return impl::occupancy_level_side(level); }
+
+            static constexpr std::array<size_t, LEVEL_COUNT + 1> LEVEL_OFFSETS = impl::occupancy_level_offsets();
+
+            static constexpr size_t WORD_COUNT = LEVEL_OFFSETS[LEVEL_COUNT];
+
+            static constexpr size_t bit_index(ui32 level, ui32 x, ui32 y, ui32 z) {
+                return x + static_cast<size_t>(side(level)) * (y + static_cast<size_t>(side(level)) * z);
+            }
+
+            bool get_bit(ui32 level, ui32 x, ui32 y, ui32 z) const {
+                const size_t bit = bit_index(level, x, y, z);
+
+                return (m_bits[LEVEL_OFFSETS[level] + bit / 64] >> (bit % 64)) & 1;
+            }
+            void set_bit(ui32 level, ui32 x, ui32 y, ui32 z, bool solid);
+
+            /**
+             * @brief Gets whether any of the 2x2x2 cells of the
+             * level below making up the given cell are solid.
+             */
+            bool any_child_solid(ui32 level, ui32 x, ui32 y, ui32 z) const;
+
+            /**
+             * @brief Allocates bits for a uniform pyramid, setting
+             * all of them to its uniform occupancy.
+             */
+            void expand();
+
+            bool any_solid(ui32 level, ui32 x, ui32 y, ui32 z, BlockChunkPosition start, BlockChunkPosition end) const;
+
+            ui64* m_bits;
+            bool  m_uniform_solid;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_chunk_occupancy_pyramid_h
@@ -2,8 +2,10 @@
 #define __hemlock_voxel_chunk_renderer_h
 
 #include "timing.h"
+#include "camera/frustum.h"
 #include "graphics/mesh.h"
 #include "voxel/coordinate_system.h"
+#include "voxel/chunk/mesh/instance_manager.h"
 
 namespace hemlock {
     namespace voxel {
@@ -15,11 +17,45 @@ namespace hemlock {
 
         using PagedChunks = std::vector<ChunkID>;
 
+        /**
+         * @brief How the renderer issues draws of its pages.
+         *
+         * Per page draws each page with its own buffer, and quads
+         * chunk by chunk. Multi-draw indirect keeps all pages in
+         * one buffer and draws every chunk with one command of a
+         * single glMultiDrawArraysIndirect.
+         */
+        enum class ChunkDrawMode : ui8 {
+            PER_PAGE            = 0,
+            MULTI_DRAW_INDIRECT = 1
+        };
+
+        /**
+         * @brief A command of a GL_DRAW_INDIRECT_BUFFER, as read
+         * by glMultiDrawArraysIndirect.
+         */
+        struct ChunkDrawCommand {
+            ui32 count;
+            ui32 instance_count;
+            ui32 first;
+            ui32 base_instance;
+        };
+        using ChunkDrawCommands = std::vector<ChunkDrawCommand>;
+
+        /**
+         * @brief Where a chunk lives on the GPU. The chunk owns
+         * the range of its page from on_gpu_offset, of which
+         * the first on_gpu_voxel_count are in use. All offsets
+         * and counts are in instances, or quads. The draw index
+         * is that of the chunk's draw command, when drawing by
+         * multi-draw indirect.
+         */
         struct PagedChunkMetadata {
             ui32 page_idx;
             ui32 chunk_idx;
+            ui32 draw_idx;
             ui32 on_gpu_offset;
-            ui32 on_gpu_page_idx;
+            ui32 on_gpu_capacity;
             ui32 on_gpu_voxel_count;
             bool dirty;
             bool paged;
@@ -31,15 +67,80 @@ namespace hemlock {
         };
         using PagedChunkQueue       = moodycamel::ConcurrentQueue<HandleAndID>;
 
+        struct ChunkRenderPageRange {
+            ui32 offset, size;
+        };
+        using ChunkRenderPageRanges = std::vector<ChunkRenderPageRange>;
+
+        /**
+         * @brief A GPU buffer suballocated between chunks.
+         *
+         * Free ranges are kept sorted by offset and coalesced.
+         * The voxel count is the extent of the page, one past
+         * the last instance of any range in use, and is what
+         * is drawn of the page. Instances within it that no
+         * chunk is using are kept zeroed so that they draw as
+         * nothing.
+         *
+         * While a page holds any chunks, all of them are from the
+         * one region of the grid, and the page's AABB bounds them
+         * in world space, min inclusive and max exclusive.
+         *
+         * The page starts base instances into its buffer, which
+         * is only ever non-zero when pages share one buffer.
+         */
         struct ChunkRenderPage {
-            PagedChunks chunks;
-            ui32        voxel_count;
-            GLuint      vbo;
-            bool        dirty;
-            ui32        first_dirtied_chunk_idx;
+            PagedChunks             chunks;
+            ChunkRenderPageRanges   free_ranges;
+            ui32                    allocated;
+            ui32                    voxel_count;
+            ChunkGridPosition       region;
+            BlockWorldPosition      aabb_min, aabb_max;
+            ui32                    base;
+            GLuint                  vbo;
         };
         using ChunkRenderPages = std::vector<ChunkRenderPage*>;
 
+        /**
+         * @brief Pages chunk meshes onto the GPU and draws them.
+         *
+         * Meshes written into the renderer's staging buffer are
+         * copied into pages on the GPU, and only meshes that
+         * could not get a block of it are uploaded from the CPU.
+         *
+         * Cuboid instances are drawn instanced over a cube mesh,
+         * with translation and scaling at attributes 3 and 4.
+         *
+         * Face quads are drawn by vertex pulling, with no vertex
+         * attributes at all. Each page is bound as a shader
+         * storage buffer of uvec2 at binding 0, and each chunk in
+         * it drawn as six vertices per quad starting at vertex
+         * six times the chunk's first quad, with the world
+         * position of the chunk's origin block set to the ivec3
+         * uniform chunk_position of the program in use. The
+         * vertex shader then finds its quad at gl_VertexID / 6
+         * and its corner at gl_VertexID % 6, unpacking the quad
+         * as laid out in ChunkQuadData.
+         *
+         * Chunks are bucketed into pages by region of the grid,
+         * so that each page covers a small part of the world and
+         * pages wholly outside the camera's frustum can be skipped
+         * when drawing. Quads, drawn chunk by chunk, are further
+         * culled chunk by chunk. The frustum's far plane serves as
+         * the distance cull.
+         *
+         * When drawing by multi-draw indirect, all pages are kept
+         * in one buffer and each chunk has a draw command, the
+         * commands being uploaded only when chunks change. Cuboids
+         * are drawn as before, each command's base instance being
+         * the chunk's first instance. Quads are drawn with all
+         * pages bound at binding 0, and as the draw's uniforms
+         * cannot vary by command, the chunk's position is instead
+         * given as the ivec3 attribute 0, which the command's base
+         * instance selects. No culling is done on the CPU; if a cull
+         * program is set, it is dispatched before drawing to cull
+         * commands on the GPU, see set_cull_program.
+         */
         class ChunkRenderer {
         public:
             ChunkRenderer();
@@ -52,8 +153,14 @@ namespace hemlock {
              * page in units of half a block-volume of a chunk.
              * @param max_unused_pages The maximum number of pages that
              * will be retained that are not being used.
+             * @param mesh_output The kind of mesh chunks will be
+             * given by their mesh tasks.
+             * @param draw_mode How pages are to be drawn.
              */
-            void init(ui32 page_size, ui32 max_unused_pages);
+            void init( ui32 page_size,
+                       ui32 max_unused_pages,
+            ChunkMeshOutput mesh_output = ChunkMeshOutput::CUBOID_INSTANCES,
+              ChunkDrawMode draw_mode   = ChunkDrawMode::PER_PAGE );
             void dispose();
 
             /**
@@ -65,10 +172,67 @@ namespace hemlock {
             void set_page_size(ui32 page_size);
 
             ui32 page_size()       const { return m_page_size;                                            };
-            ui32 block_page_size() const { return m_page_size * CHUNK_VOLUME / 2; };
+            /**
+             * @brief The number of instances, or quads, that fit
+             * in a page. Pages take the same memory either way,
+             * so hold proportionally more of the smaller quads.
+             */
+            ui32 block_page_size() const {
+                return static_cast<ui32>(m_page_size * CHUNK_VOLUME / 2 * sizeof(ChunkInstanceData) / mesh_element_size());
+            }
+
+            ChunkMeshOutput mesh_output() const { return m_mesh_output; }
+            ChunkDrawMode   draw_mode()   const { return m_draw_mode;   }
+
+            /**
+             * @brief Sets a compute program with which to cull draw
+             * commands against the frustum, when drawing by multi-draw
+             * indirect. Zero, the default, culls nothing.
+             *
+             * The program is dispatched in groups of 64 invocations,
+             * one per command, with the commands as an SSBO of uvec4
+             * at binding 1, the chunk position of each command as an
+             * SSBO of ivec4 at binding 2 and the commands to draw as
+             * an SSBO of uvec4 at binding 3. The frustum is given by
+             * the uniform vec4 frustum_planes[6], as in hcam::Frustum,
+             * and the number of commands by the uniform uint
+             * command_count. Each command should be written out as it
+             * is, but with an instance count of zero if culled.
+             *
+             * @param program The compute program.
+             */
+            void set_cull_program(GLuint program) { m_cull_program = program; }
+
+            /**
+             * @brief The staging buffer that chunks added to the
+             * renderer should have their mesh tasks write into.
+             */
+            hmem::Handle<ChunkStagingBuffer> staging_buffer() { return m_staging_buffer; }
 
             void update(FrameTime time);
-            void draw(FrameTime time);
+            /**
+             * @brief Draws those pages, and for quads those
+             * chunks, that are within the frustum of the
+             * given view-projection matrix.
+             *
+             * @param time The time data for the frame.
+             * @param view_projection The view-projection matrix
+             * of the camera drawn from.
+             */
+            void draw(FrameTime time, const f32m4& view_projection);
+            /**
+             * @brief Draws those pages, and for quads those
+             * chunks, that are within the frustum of the
+             * camera.
+             *
+             * @param time The time data for the frame.
+             * @param camera The camera drawn from, any meeting
+             * hcam::Camera as in camera/camera_concept.hpp.
+             */
+            template <typename CameraType>
+            void draw(FrameTime time, CameraType* camera) {
+                draw(time, camera->view_projection_matrix());
+            }
 
             /**
              * @brief Adds a chunk to the renderer, the
@@ -81,6 +245,7 @@ namespace hemlock {
             void add_chunk(hmem::WeakHandle<Chunk> handle);
         protected:
             static hg::MeshHandles block_mesh_handles;
+            static GLuint          quad_vao;
 
             Subscriber<>    handle_chunk_mesh_change;
             Subscriber<>    handle_chunk_unload;
@@ -96,23 +261,136 @@ namespace hemlock {
             inline ChunkRenderPage* create_pages(ui32 count);
 
             /**
-             * @brief Puts a chunk in the first page starting
-             * from the given index that has enough space for it.
+             * @brief Gives a chunk a range in the first page of its
+             * region with a large enough free range, else in the
+             * first page holding no chunks, creating a page if no
+             * page will do.
              *
              * @param chunk_id The ID of the chunk to find a page for.
              * @param instance_count The number of instances representing the chunk.
-             * @param first_page_idx The index of the first page
-             * to consider.
              */
-            void put_chunk_in_page(ChunkID chunk_id, ui32 instance_count, ui32 first_page_idx);
+            void put_chunk_in_page(ChunkID chunk_id, ui32 instance_count);
+            /**
+             * @brief Releases the range a chunk has in its page,
+             * zeroing the instances it was using.
+             *
+             * @param chunk_id The ID of the chunk to remove.
+             */
+            void remove_chunk_from_page(ChunkID chunk_id);
+
+            /**
+             * @brief Recalculates the AABB of the page from the
+             * chunks left in it.
+             *
+             * @param page The page to recalculate the AABB of.
+             */
+            void update_page_aabb(ChunkRenderPage& page);
+
+            /**
+             * @brief Allocates a range from the page's free
+             * ranges, first fit.
+             *
+             * @param page The page to allocate from.
+             * @param size The size of the range to allocate.
+             * @param offset Set to the offset of the range.
+             * @return True if a range was allocated, false if
+             * no free range was large enough.
+             */
+            bool allocate_range(ChunkRenderPage& page, ui32 size, OUT ui32& offset);
+            /**
+             * @brief Returns a range to the page's free ranges,
+             * coalescing it with its neighbours.
+             *
+             * @param page The page to free the range in.
+             * @param offset The offset of the range.
+             * @param size The size of the range.
+             */
+            void free_range(ChunkRenderPage& page, ui32 offset, ui32 size);
+
+            /**
+             * @brief Zeroes a range of instances of the page,
+             * which are then drawn as nothing.
+             */
+            void clear_range(ChunkRenderPage& page, ui32 offset, ui32 count);
+
+            /**
+             * @brief Packs the chunks of a page to its front,
+             * leaving it a single free range.
+             *
+             * @param page The page to compact.
+             */
+            void compact_page(ChunkRenderPage& page);
 
             /**
              * @brief Updates chunks, removing those that
-             * are to be removed and then processing pages
-             * that have dirtied chunks.
+             * are to be removed and then uploading the meshes
+             * of those that are dirty. Each dirty chunk is
+             * written over its previous mesh if that range
+             * can hold it, and otherwise moved.
+             *
+             * At most one page, the most fragmented, is then
+             * compacted if enough of it is going unused.
              */
             void process_pages();
 
+            /**
+             * @brief Draws pages of face quads, one draw per
+             * chunk.
+             */
+            void draw_quads();
+
+            /**
+             * @brief Draws all chunks with one multi-draw indirect,
+             * first culling draw commands if a cull program is set.
+             */
+            void draw_indirect();
+
+            /**
+             * @brief Gives the chunk a draw command.
+             */
+            void add_draw_command(ChunkID chunk_id);
+            /**
+             * @brief Drops the chunk's draw command, moving the
+             * last command into its place.
+             */
+            void remove_draw_command(ChunkID chunk_id);
+            /**
+             * @brief Sets the chunk's draw command to draw its
+             * current range of its page.
+             */
+            void update_draw_command(const PagedChunkMetadata& metadata);
+            /**
+             * @brief Uploads draw commands, and the positions of their
+             * chunks, if any have changed since last uploaded.
+             */
+            void upload_draw_commands();
+
+            /**
+             * @brief Determines if the given page is at least
+             * partly within the frustum being drawn.
+             */
+            bool page_in_frustum(const ChunkRenderPage& page) const {
+                return m_frustum.intersects(f32v3{page.aabb_min}, f32v3{page.aabb_max});
+            }
+
+            size_t mesh_element_size() const {
+                return m_mesh_output == ChunkMeshOutput::FACE_QUADS ?
+                            sizeof(ChunkQuadData) : sizeof(ChunkInstanceData);
+            }
+
+            /**
+             * @brief The number of instances, or quads, in the
+             * mesh of the given chunk instance.
+             */
+            ui32 mesh_element_count(const ChunkInstance& instance) const {
+                return m_mesh_output == ChunkMeshOutput::FACE_QUADS ?
+                            instance.quad_count : instance.count;
+            }
+            const void* mesh_element_data(const ChunkInstance& instance) const {
+                return m_mesh_output == ChunkMeshOutput::FACE_QUADS ?
+                            static_cast<const void*>(instance.quads) : static_cast<const void*>(instance.data);
+            }
+
             AllPagedChunks      m_all_paged_chunks;
             ChunkRenderPages    m_chunk_pages;
             PagedChunksMetadata m_chunk_metadata;
@@ -121,6 +399,26 @@ namespace hemlock {
 
             ui32 m_page_size;
             ui32 m_max_unused_pages;
+
+            ChunkMeshOutput m_mesh_output;
+            ChunkDrawMode   m_draw_mode;
+
+            hcam::Frustum m_frustum;
+
+            // Only used when drawing by multi-draw indirect.
+            GLuint              m_page_buffer;
+            ChunkDrawCommands   m_draw_commands;
+            std::vector<i32v4>  m_draw_positions;
+            PagedChunks         m_draw_chunks;
+            bool                m_draw_commands_dirty;
+            ui32                m_draw_command_capacity;
+            GLuint              m_command_buffer;
+            GLuint              m_culled_command_buffer;
+            GLuint              m_position_buffer;
+            GLuint              m_indirect_vao;
+            GLuint              m_cull_program;
+
+            hmem::Handle<ChunkStagingBuffer> m_staging_buffer;
         };
     }
 }
@@ -0,0 +1,138 @@
+#ifndef __hemlock_voxel_chunk_slot_map_h
+#define __hemlock_voxel_chunk_slot_map_h
+
+namespace hemlock {
+    namespace voxel {
+        struct Chunk;
+
+        /**
+         * @brief Handle on a slot of a chunk slot map. The handle
+         * is only valid so long as its generation matches that of
+         * the slot, a generation of zero being a null handle.
+         */
+        struct ChunkSlotHandle {
+            ui32 index;
+            ui32 generation;
+        };
+
+        /**
+         * @brief Holds chunks in stable slots, such that they can be
+         * linked to by plain slot handles rather than weak handles,
+         * checking a link is valid then being a compare of generations
+         * rather than a pair of atomic reference count updates.
+         *
+         * Slots are acquired and released only by the thread owning
+         * the map, but may be read from any thread. The chunk of a
+         * released slot, and the slot itself, are kept until every
+         * task pinned before the release has finished, so a task
+         * having found a chunk through its slot can use it without
+         * it being freed from under it.
+         */
+        class ChunkSlotMap {
+        public:
+            ChunkSlotMap();
+            ~ChunkSlotMap() { /* Empty. */ }
+
+            /**
+             * @brief Releases all slots and the chunks held by them.
+             *
+             * NOTE: this must only be called once no task that may
+             * read the map is still running.
+             */
+            void dispose();
+
+            /**
+             * @brief Acquires a slot for the given chunk.
+             *
+             * @param chunk The chunk to hold.
+             * @return The handle on the chunk's slot, or a null handle
+             * if the map is full.
+             */
+            ChunkSlotHandle acquire(hmem::Handle<Chunk> chunk);
+            /**
+             * @brief Releases the slot of the given handle, after
+             * which the handle, and any copy of it, is invalid.
+             *
+             * @param handle The handle on the slot to release.
+             */
+            void release(ChunkSlotHandle handle);
+
+            /**
+             * @brief Gets the chunk held by the slot of the given
+             * handle.
+             *
+             * NOTE: this is thread-safe, but the chunk returned is
+             * only guaranteed to live as long as the pin taken out
+             * by the calling task.
+             *
+             * @param handle The handle on the chunk's slot.
+             * @return The chunk if the handle is valid, nullptr
+             * otherwise.
+             */
+            Chunk* get(ChunkSlotHandle handle) const {
+                if (handle.generation == 0) return nullptr;
+
+                const Slot& slot = slot_at(handle.index);
+                if (slot.generation.load(std::memory_order_acquire) != handle.generation) return nullptr;
+
+                return slot.chunk;
+            }
+
+            /**
+             * @brief Pins the slots currently acquired, such that none
+             * released from now are reused, nor their chunks freed,
+             * until the pin is undone.
+             *
+             * @return The grace period pinned, to be passed to unpin.
+             */
+            ui32 pin();
+            /**
+             * @brief Undoes a pin.
+             *
+             * NOTE: this is thread-safe.
+             *
+             * @param grace_period The grace period that was pinned.
+             */
+            void unpin(ui32 grace_period);
+
+            /**
+             * @brief Reclaims the slots, and frees the chunks, that
+             * were released before any task still pinned began.
+             */
+            void reclaim();
+        protected:
+            static constexpr ui32 SLOT_PAGE_SIZE = 1024;
+            static constexpr ui32 MAX_SLOT_PAGES = 1024;
+
+            struct Slot {
+                std::atomic<ui32>   generation;
+                Chunk*              chunk;
+                hmem::Handle<Chunk> handle;
+            };
+
+            Slot& slot_at(ui32 index) const {
+                return m_pages[index / SLOT_PAGE_SIZE][index % SLOT_PAGE_SIZE];
+            }
+
+            // NOTE(Matthew): pages are never moved once allocated, and
+            //                the page table is of a fixed size, so that
+            //                other threads can read slots without any
+            //                lock while new pages are added.
+            std::unique_ptr<Slot[]> m_pages[MAX_SLOT_PAGES];
+            ui32                    m_slot_count;
+            std::vector<ui32>       m_free_slots;
+
+            // NOTE(Matthew): two grace periods are enough - slots
+            //                released in the current period are
+            //                reclaimed once every task pinned in the
+            //                previous period has finished, at which
+            //                point the periods are swapped.
+            ui32                m_grace_period;
+            std::atomic<ui32>   m_pinned_tasks[2];
+            std::vector<ui32>   m_released_slots[2];
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_chunk_slot_map_h
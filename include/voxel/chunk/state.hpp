@@ -1,6 +1,9 @@
 #ifndef __hemlock_voxel_chunk_state_hpp
 #define __hemlock_voxel_chunk_state_hpp
 
+#include "voxel/chunk/constants.hpp"
+#include "voxel/chunk/slot_map.h"
+
 namespace hemlock {
     namespace voxel {
         struct Chunk;
@@ -31,25 +34,50 @@ namespace hemlock {
             FULL    = 9
         };
 
+        /**
+         * @brief The length in blocks of the cells a chunk in the
+         * given render state is meshed from. FULL, and NONE, are
+         * meshed block by block, LOD_7 from cells of 2^3 blocks,
+         * LOD_6 from cells of 4^3 blocks and so on, down to cells
+         * spanning the whole chunk.
+         *
+         * @param render_state The render state of the chunk.
+         * @return The length of the chunk's cells.
+         */
+        inline ui32 lod_cell_length(RenderState render_state) {
+            if (render_state == RenderState::NONE || render_state == RenderState::FULL) return 1;
+
+            const ui32 steps = static_cast<ui32>(RenderState::FULL) - static_cast<ui32>(render_state);
+
+            return std::min(ui32{1} << steps, static_cast<ui32>(CHUNK_LENGTH));
+        }
+
+        /**
+         * @brief Links to the face neighbours of a chunk, each a
+         * handle on the neighbour's slot in the grid's slot map.
+         *
+         * NOTE: links are set by the grid, and may be read from
+         * any thread.
+         */
         union Neighbours {
             Neighbours() :
-                all({})
+                all{}
             { /* Empty. */ }
             Neighbours(const Neighbours& rhs) {
-                for (size_t i = 0; i < 8; ++i) all[i] = rhs.all[i];
+                for (size_t i = 0; i < 6; ++i) all[i].store(rhs.all[i].load(std::memory_order_acquire), std::memory_order_release);
             }
             ~Neighbours() { /* Empty. */ }
 
 
             Neighbours& operator=(const Neighbours& rhs) {
-                for (size_t i = 0; i < 8; ++i) all[i] = rhs.all[i];
+                for (size_t i = 0; i < 6; ++i) all[i].store(rhs.all[i].load(std::memory_order_acquire), std::memory_order_release);
                 return *this;
             }
 
             struct {
-                hmem::WeakHandle<Chunk> left, right, top, bottom, front, back;
+                std::atomic<ChunkSlotHandle> left, right, top, bottom, front, back;
             } one;
-            hmem::WeakHandle<Chunk> all[8];
+            std::atomic<ChunkSlotHandle> all[6];
         };
     }
 }
@@ -1,6 +1,9 @@
 #ifndef __hemlock_voxel_chunk_load_task_hpp
 #define __hemlock_voxel_chunk_load_task_hpp
 
+#include "voxel/coordinate_system.h"
+#include "voxel/chunk/slot_map.h"
+
 namespace hemlock {
     namespace voxel {
         struct Chunk;
@@ -19,12 +22,82 @@ namespace hemlock {
 
         class ChunkTask : public thread::IThreadTask<ChunkTaskContext> {
         public:
-            virtual ~ChunkTask() { /* Empty. */ }
+            virtual ~ChunkTask();
 
+            /**
+             * @brief Sets the chunk the task is for and the grid
+             * holding it, pinning the grid's chunk slots such that
+             * chunks found through them by the task live until the
+             * task is destroyed.
+             *
+             * @param chunk The chunk the task is for.
+             * @param chunk_grid The grid holding the chunk.
+             */
             void set_state(hmem::WeakHandle<Chunk> chunk, hmem::WeakHandle<ChunkGrid> chunk_grid);
+
+            /**
+             * @brief Sets the mesh epoch of the chunk this task was
+             * queued at. The task is cancelled once the chunk's mesh
+             * epoch moves on, as a later mesh task supersedes it.
+             * Tasks not given a mesh epoch are never superseded.
+             *
+             * @param mesh_epoch The mesh epoch of the task.
+             */
+            void set_mesh_epoch(ui32 mesh_epoch) { m_mesh_epoch = mesh_epoch; }
+
+            /**
+             * @brief Whether the task's chunk has been unloaded or,
+             * for mesh tasks, the task has been superseded.
+             *
+             * @return True if the task is cancelled, false otherwise.
+             */
+            virtual bool is_cancelled() override;
+
+            /**
+             * @brief The position of the chunk the task is for,
+             * kept so that the task can be prioritised without
+             * locking the chunk.
+             */
+            ChunkGridPosition chunk_position() const { return m_chunk_position; }
         protected:
+            /**
+             * @brief Gets the chunk linked to, such as one of the
+             * neighbours of the task's chunk.
+             *
+             * @param link The link to the chunk.
+             * @return The chunk if still held by the grid, nullptr
+             * otherwise.
+             */
+            Chunk* linked_chunk(const std::atomic<ChunkSlotHandle>& link) const {
+                if (m_chunk_slots == nullptr) return nullptr;
+
+                return m_chunk_slots->get(link.load(std::memory_order_acquire));
+            }
+
+            /**
+             * @brief Completes a mesh task without a mesh pass if the
+             * chunk would mesh to nothing, that is it holds no solid
+             * block, or is solid throughout and every face of it is
+             * against a face of a neighbour that is wholly solid.
+             *
+             * An empty mesh is only handed to the renderer if the
+             * chunk's last mesh was not already empty, and so chunks
+             * that have only ever been empty are never paged.
+             *
+             * @param chunk The chunk being meshed.
+             * @param quad_buffer Whether the chunk is meshed to face
+             * quads, rather than cuboid instances.
+             * @return True if the mesh task was completed, false if
+             * the chunk is to be meshed as normal.
+             */
+            bool complete_if_empty_mesh(Chunk* chunk, bool quad_buffer = false);
+
             hmem::WeakHandle<Chunk>     m_chunk;
             hmem::WeakHandle<ChunkGrid> m_chunk_grid;
+            ChunkGridPosition           m_chunk_position;
+            ui32                        m_mesh_epoch = 0;
+            ChunkSlotMap*               m_chunk_slots = nullptr;
+            ui32                        m_grace_period = 0;
         };
     }
 }
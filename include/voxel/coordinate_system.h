@@ -130,6 +130,15 @@ namespace hemlock {
          * @return ChunkGridPosition The grid position of the enclosing chunk.
          */
         ChunkGridPosition chunk_grid_position(BlockWorldPosition block_world_position);
+
+        /**
+         * @brief Converts a chunk grid position into the world position of the
+         * column of chunks in which the chunk exists.
+         *
+         * @param chunk_grid_position The position of the chunk within grid space.
+         * @return ColumnWorldPosition The world position of the enclosing column.
+         */
+        ColumnWorldPosition column_world_position(ChunkGridPosition chunk_grid_position);
     }
 }
 namespace hvox = hemlock::voxel;
@@ -2,24 +2,29 @@
 #define __hemlock_voxel_io_chunk_file_task_hpp
 
 #include "io/io_task.hpp"
+#include "voxel/coordinate_system.h"
 
 namespace hemlock {
     namespace voxel {
-        struct Chunk;
+        class ChunkRegionStore;
 
         using ChunkFileTaskThreadState = io::IOTaskThreadState;
         using ChunkFileTaskTaskQueue   = io::IOTaskTaskQueue;
 
         class ChunkFileTask : public io::IOTask {
         public:
-            void init(hmem::WeakHandle<Chunk> chunk, io::IOManagerBase* iomanager) {
+            void init(ChunkGridPosition chunk_position, ChunkRegionStore* region_store, io::IOManagerBase* iomanager) {
                 io::IOTask::init(iomanager);
 
-                m_chunk = chunk;
+                m_chunk_position = chunk_position;
+                m_region_store   = region_store;
             }
         protected:
-            hmem::WeakHandle<Chunk> m_chunk;
-            // static hio::fs::mapped_file chunk_data_file;
+            // NOTE(Matthew): we hold onto the position rather than a handle
+            //                on the chunk, as a chunk is typically saved as
+            //                it is unloaded.
+            ChunkGridPosition m_chunk_position;
+            ChunkRegionStore* m_region_store;
         };
     }
 }
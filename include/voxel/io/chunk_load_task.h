@@ -1,16 +1,26 @@
 #ifndef __hemlock_voxel_io_chunk_load_task_h
 #define __hemlock_voxel_io_chunk_load_task_h
 
-#include "voxel/io/chunk_file_task.h"
+#include "voxel/chunk/generator_task.hpp"
 
 namespace hemlock {
     namespace voxel {
-        // class ChunkLoadTask : public ChunkFileTask {
-        // public:
-        //     virtual void execute(ChunkFileTaskThreadState* state, ChunkFileTaskTaskQueue* task_queue) override;
-        // };
+        /**
+         * @brief Loads a chunk from its region file if it has
+         * been saved, and otherwise generates it with the
+         * given strategy.
+         */
+        template <hvox::ChunkGenerationStrategy GenerationStrategy>
+        class ChunkLoadTask : public ChunkGenerationTask<GenerationStrategy> {
+        public:
+            virtual ~ChunkLoadTask() { /* Empty. */ }
+
+            virtual void execute(ChunkLoadThreadState* state, ChunkTaskQueue* task_queue) override;
+        };
     }
 }
 namespace hvox = hemlock::voxel;
 
+#include "voxel/io/chunk_load_task.inl"
+
 #endif // __hemlock_voxel_io_chunk_load_task_h
@@ -0,0 +1,38 @@
+#include "voxel/chunk.h"
+#include "voxel/chunk/grid.h"
+#include "voxel/io/region_store.h"
+
+template <hvox::ChunkGenerationStrategy GenerationStrategy>
+void hvox::ChunkLoadTask<GenerationStrategy>::execute(ChunkLoadThreadState* state, ChunkTaskQueue* task_queue) {
+    auto chunk = this->m_chunk.lock();
+
+    if (chunk == nullptr) return;
+
+    ChunkRegionStore* region_store = nullptr;
+    {
+        auto chunk_grid = this->m_chunk_grid.lock();
+
+        if (chunk_grid != nullptr) region_store = chunk_grid->region_store();
+    }
+
+    if (region_store != nullptr) {
+        chunk->gen_task_active.store(true, std::memory_order_release);
+
+        if (region_store->load(chunk)) {
+            chunk->state.store(ChunkState::GENERATED, std::memory_order_release);
+
+            chunk->gen_task_active.store(false, std::memory_order_release);
+
+            chunk->on_load();
+
+            chunk->pending_task.store(ChunkTaskKind::NONE, std::memory_order_release);
+
+            return;
+        }
+
+        chunk->gen_task_active.store(false, std::memory_order_release);
+    }
+
+    // Not on disk, so fall back to generating the chunk.
+    ChunkGenerationTask<GenerationStrategy>::execute(state, task_queue);
+}
@@ -5,10 +5,14 @@
 
 namespace hemlock {
     namespace voxel {
-        // class ChunkSaveTask : public ChunkFileTask {
-        // public:
-        //     virtual void execute(ChunkFileTaskThreadState* state, ChunkFileTaskTaskQueue* task_queue) override;
-        // };
+        /**
+         * @brief Writes the pending save of a chunk to its
+         * region file.
+         */
+        class ChunkSaveTask : public ChunkFileTask {
+        public:
+            virtual void execute(ChunkFileTaskThreadState* state, ChunkFileTaskTaskQueue* task_queue) override;
+        };
     }
 }
 namespace hvox = hemlock::voxel;
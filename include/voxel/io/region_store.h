@@ -0,0 +1,142 @@
+#ifndef __hemlock_voxel_io_region_store_h
+#define __hemlock_voxel_io_region_store_h
+
+#include "voxel/coordinate_system.h"
+
+#ifndef REGION_LENGTH
+#define REGION_LENGTH 16
+#endif
+
+#undef REGION_AREA
+#define REGION_AREA REGION_LENGTH * REGION_LENGTH
+
+#undef REGION_VOLUME
+#define REGION_VOLUME REGION_LENGTH * REGION_LENGTH * REGION_LENGTH
+
+namespace hemlock {
+    namespace io {
+        class IOManagerBase;
+    }
+
+    namespace voxel {
+        struct Chunk;
+
+        /**
+         * @brief Unique ID of a region, regions being
+         * the REGION_LENGTH^3 blocks of chunks stored
+         * together in a single file.
+         */
+        using RegionID = ui64;
+
+        /**
+         * @brief Entry of a region file's offset table,
+         * locating the compressed payload of one chunk.
+         * A size of zero means the chunk was never saved.
+         */
+        struct RegionFileEntry {
+            ui64 offset;
+            ui32 size;
+            ui32 capacity;
+        };
+
+        /**
+         * @brief Persists chunks to region files on disk.
+         *
+         * Each region file starts with a header holding a magic
+         * number, a version and an offset table of REGION_VOLUME
+         * entries, followed by the zlib-compressed serialised
+         * block storage of each chunk saved. A chunk is rewritten
+         * in place if its new payload fits the space it had been
+         * given, otherwise it is appended to the end of the file.
+         *
+         * Saves are snapshotted on the calling thread, then
+         * compressed and written on the store's own I/O thread
+         * pool. Until written, a snapshot is kept in memory and
+         * any load of that chunk is served from it, so that a
+         * chunk unloaded and swiftly reloaded never sees stale
+         * data on disk.
+         */
+        class ChunkRegionStore {
+        public:
+            ChunkRegionStore();
+            ~ChunkRegionStore() { /* Empty. */ }
+
+            /**
+             * @brief Initialises the region store.
+             *
+             * @param iomanager The IO manager through which
+             * region files are resolved.
+             * @param directory The directory in which region
+             * files are kept.
+             * @param thread_count The number of threads on
+             * which to write chunks.
+             */
+            void init( io::IOManagerBase* iomanager,
+                        const io::fs::path& directory,
+                                       ui32 thread_count = 1 );
+            /**
+             * @brief Disposes of the region store, writing any
+             * saves still pending before returning.
+             */
+            void dispose();
+
+            /**
+             * @brief Loads the blocks of the chunk from disk, or
+             * from a pending save of it, if it has been saved. The
+             * chunk's modified flag is cleared if so.
+             *
+             * NOTE: this blocks on file IO, and is intended to
+             * be called from chunk tasks.
+             *
+             * @param chunk The chunk to load.
+             * @return True if the chunk was found and its blocks
+             * set, false otherwise.
+             */
+            bool load(hmem::Handle<Chunk> chunk);
+            /**
+             * @brief Snapshots the blocks of the chunk and queues
+             * them to be written to disk, clearing the chunk's
+             * modified flag.
+             *
+             * @param chunk The chunk to save.
+             * @return True if a save was queued, false otherwise.
+             * False usually will mean the chunk has not yet been
+             * generated and so has nothing worth saving.
+             */
+            bool save(hmem::Handle<Chunk> chunk);
+
+            /**
+             * @brief Writes the pending save of the chunk at the
+             * given position to disk, if any.
+             *
+             * @param chunk_position The position of the chunk.
+             * @return True if the chunk's pending save was written
+             * or there was none, false if writing failed.
+             */
+            bool write_pending(ChunkGridPosition chunk_position);
+        protected:
+            using Payload = std::shared_ptr<const std::vector<ui8>>;
+
+            io::fs::path region_path(ChunkGridPosition region_position) const;
+
+            std::shared_mutex& region_mutex(RegionID id);
+
+            bool read_payload (ChunkGridPosition chunk_position, OUT std::vector<char>& payload);
+            bool write_payload(ChunkGridPosition chunk_position, const std::vector<ui8>& payload);
+
+            io::IOManagerBase*  m_iomanager;
+            io::fs::path        m_directory;
+
+            thread::ThreadPool<thread::BasicThreadContext> m_thread_pool;
+
+            std::mutex                              m_pending_saves_mutex;
+            std::unordered_map<ChunkID, Payload>    m_pending_saves;
+
+            std::mutex                                                          m_region_mutexes_mutex;
+            std::unordered_map<RegionID, std::unique_ptr<std::shared_mutex>>    m_region_mutexes;
+        };
+    }
+}
+namespace hvox = hemlock::voxel;
+
+#endif // __hemlock_voxel_io_region_store_h
@@ -11,6 +11,28 @@ namespace hemlock {
         namespace Ray {
             using BlockTest = Delegate<bool(const Block&)>;
 
+            using RayCastThreadPool = thread::ThreadPool<thread::BasicThreadContext>;
+
+            /**
+             * @brief A ray to be cast by cast_many.
+             */
+            struct RayCast {
+                f32v3 start;
+                f32v3 direction;
+                ui32  max_steps;
+            };
+
+            /**
+             * @brief The result of a ray cast by cast_many, position
+             * and distance being those of the block the ray met, and
+             * only set if the ray hit a target block.
+             */
+            struct RayHit {
+                BlockWorldPosition  position;
+                f32                 distance;
+                bool                hit;
+            };
+
             /**
              * @brief Steps the ray along its direction until the
              * first block that is exactly the specified target block.
@@ -121,9 +143,83 @@ namespace hemlock {
                                            ui32 max_steps,
                         OUT BlockWorldPosition& position,
                                        OUT f32& distance    );
+
+            /**
+             * @brief As cast_to_block taking a BlockTest, but with
+             * the test inlined into the traversal of the ray rather
+             * than called through a delegate.
+             *
+             * The ray steps from block to block, and from chunk to
+             * chunk through neighbour links rather than lookups in
+             * the grid, holding the lock of the chunk it is in for
+             * as long as it is in it. Blocks of chunks holding no
+             * solid block are not looked at at all, unless the test
+             * would match NULL_BLOCK. The distance is that along the
+             * ray to where it enters the block, and so in blocks if
+             * direction is normalised.
+             */
+            template <typename BlockTestType>
+                requires std::is_invocable_r_v<bool, BlockTestType&, const Block&>
+            bool cast_to_block(           f32v3 start,
+                                          f32v3 direction,
+                    hmem::WeakHandle<ChunkGrid> grid_handle,
+                                  BlockTestType block_is_target,
+                                           ui32 max_steps,
+                        OUT BlockWorldPosition& position,
+                                       OUT f32& distance    );
+
+            /**
+             * @brief As cast_to_block_before taking a BlockTest, but
+             * with the test inlined into the traversal of the ray, as
+             * for the templated cast_to_block.
+             */
+            template <typename BlockTestType>
+                requires std::is_invocable_r_v<bool, BlockTestType&, const Block&>
+            bool cast_to_block_before(    f32v3 start,
+                                          f32v3 direction,
+                    hmem::WeakHandle<ChunkGrid> grid_handle,
+                                  BlockTestType block_is_target,
+                                           ui32 max_steps,
+                        OUT BlockWorldPosition& position,
+                                       OUT f32& distance    );
+
+            /**
+             * @brief Casts many rays as cast_to_block does, sharing
+             * them out between the threads of the given thread pool
+             * and the calling thread, returning once all rays have
+             * been cast.
+             *
+             * NOTE: this must be called from the thread owning the
+             * grid, which is blocked until all rays have been cast.
+             * The test is called from many threads at once.
+             *
+             * @param rays The rays to cast.
+             * @param ray_count The number of rays to cast.
+             * @param grid_handle Handle to the chunk grid in which the
+             * rays are cast.
+             * @param block_is_target The test function, must return
+             * false except for a block considered a target of a ray.
+             * @param hits The result of each ray, must hold ray_count
+             * results.
+             * @param thread_pool The thread pool to cast rays on, if
+             * nullptr all rays are cast on the calling thread.
+             * @param rays_per_task The number of rays cast by each
+             * task given to the thread pool.
+             */
+            template <typename BlockTestType>
+                requires std::is_invocable_r_v<bool, BlockTestType&, const Block&>
+            void cast_many(         const RayCast* rays,
+                                            size_t ray_count,
+                       hmem::WeakHandle<ChunkGrid> grid_handle,
+                                     BlockTestType block_is_target,
+                                       OUT RayHit* hits,
+                                RayCastThreadPool* thread_pool   = nullptr,
+                                            size_t rays_per_task = 256 );
         }
     }
 }
 namespace hvox = hemlock::voxel;
 
+#include "voxel/ray.inl"
+
 #endif // __hemlock_voxel_ray_h
@@ -0,0 +1,404 @@
+#include "voxel/chunk/grid.h"
+
+namespace hemlock {
+    namespace voxel {
+        namespace Ray {
+            namespace impl {
+                /**
+                 * @brief Steps the ray through the grid until the
+                 * first block satisfying block_is_target, setting
+                 * position and distance to that block or, if
+                 * StopBefore, the block stepped through before it.
+                 */
+                template <bool StopBefore, typename BlockTestType>
+                bool cast(                  ChunkGrid& grid,
+                                                 f32v3 start,
+                                                 f32v3 direction,
+                                        BlockTestType& block_is_target,
+                                                  ui32 max_steps,
+                               OUT BlockWorldPosition& position,
+                                              OUT f32& distance );
+
+                /**
+                 * @brief The state shared by the tasks of a call to
+                 * cast_many.
+                 */
+                template <typename BlockTestType>
+                struct RayCastBatch {
+                    ChunkGrid*          grid;
+                    const RayCast*      rays;
+                    RayHit*             hits;
+                    BlockTestType       block_is_target;
+                    std::atomic<size_t> remaining_tasks;
+                };
+
+                template <typename BlockTestType>
+                void cast_range(RayCastBatch<BlockTestType>& batch, size_t first, size_t last) {
+                    for (size_t i = first; i < last; ++i) {
+                        const RayCast& ray = batch.rays[i];
+                        RayHit&        hit = batch.hits[i];
+
+                        hit.hit = cast<false>(
+                            *batch.grid,
+                            ray.start,
+                            ray.direction,
+                            batch.block_is_target,
+                            ray.max_steps,
+                            hit.position,
+                            hit.distance
+                        );
+                    }
+                }
+
+                template <typename BlockTestType>
+                class RayCastTask : public thread::IThreadTask<thread::BasicThreadContext> {
+                public:
+                    RayCastTask(hmem::Handle<RayCastBatch<BlockTestType>> batch, size_t first, size_t last) :
+                        m_batch(batch), m_first(first), m_last(last)
+                    { /* Empty. */ }
+                    virtual ~RayCastTask() { /* Empty. */ }
+
+                    virtual void execute(
+                        thread::Thread<thread::BasicThreadContext>::State*,
+                        thread::TaskQueue<thread::BasicThreadContext>*
+                    ) override {
+                        cast_range(*m_batch, m_first, m_last);
+
+                        // NOTE(Matthew): the batch is held by this task
+                        //                until it is destroyed, so may
+                        //                be notified through safely.
+                        if (m_batch->remaining_tasks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                            m_batch->remaining_tasks.notify_all();
+                    }
+                protected:
+                    hmem::Handle<RayCastBatch<BlockTestType>> m_batch;
+                    size_t m_first, m_last;
+                };
+            }
+        }
+    }
+}
+
+template <bool StopBefore, typename BlockTestType>
+bool hvox::Ray::impl::cast(                 ChunkGrid& grid,
+                                                 f32v3 start,
+                                                 f32v3 direction,
+                                        BlockTestType& block_is_target,
+                                                  ui32 max_steps,
+                               OUT BlockWorldPosition& position,
+                                              OUT f32& distance )
+{
+    // Index into the neighbours of a chunk of the one left
+    // into when stepping back or forth along each axis.
+    static constexpr ui32 BACKWARD_NEIGHBOUR[3] = { 0, 3, 4 }; // LEFT, BOTTOM, FRONT
+    static constexpr ui32 FORWARD_NEIGHBOUR[3]  = { 1, 2, 5 }; // RIGHT, TOP, BACK
+    // Change in block index from one block to the next along
+    // each axis.
+    static constexpr i32 AXIS_STRIDE[3] = { 1, CHUNK_LENGTH, CHUNK_AREA };
+    // Smallest level of cell of air in the occupancy pyramid of
+    // a chunk jumped over, smaller cells are cheaper to step
+    // through block by block.
+    static constexpr i32 MIN_JUMP_LEVEL = 2;
+
+    BlockWorldPosition block_position = block_world_position(start);
+
+    hmem::Handle<Chunk> start_chunk = grid.chunk(chunk_grid_position(block_position));
+    if (start_chunk == nullptr) return false;
+
+    BlockChunkPosition local_position = block_chunk_position(block_position);
+
+    i32v3 local_coord = i32v3(local_position);
+    i32   block_idx   = static_cast<i32>(block_index(local_position));
+
+    /*
+     * Along each axis, t_max is the distance along the ray to
+     * the next block boundary, and t_delta that between block
+     * boundaries.
+     */
+    i32v3 step;
+    f32v3 t_max, t_delta;
+    i32v3 index_step;
+    ui32  exit_neighbour[3];
+    for (i32 axis = 0; axis < 3; ++axis) {
+        const f32 boundary = static_cast<f32>(block_position[axis]);
+
+        if (direction[axis] > 0.0f) {
+            step[axis]    = 1;
+            t_delta[axis] = 1.0f / direction[axis];
+            t_max[axis]   = (boundary + 1.0f - start[axis]) / direction[axis];
+        } else if (direction[axis] < 0.0f) {
+            step[axis]    = -1;
+            t_delta[axis] = -1.0f / direction[axis];
+            t_max[axis]   = (start[axis] - boundary) / -direction[axis];
+        } else {
+            step[axis]    = 0;
+            t_delta[axis] = std::numeric_limits<f32>::infinity();
+            t_max[axis]   = std::numeric_limits<f32>::infinity();
+        }
+
+        index_step[axis]     = step[axis] * AXIS_STRIDE[axis];
+        exit_neighbour[axis] = step[axis] > 0 ? FORWARD_NEIGHBOUR[axis] : BACKWARD_NEIGHBOUR[axis];
+    }
+
+    /*
+     * Cells of air in the occupancy pyramid of a chunk can be
+     * passed through in one go without looking at their blocks,
+     * so long as air is not a target.
+     */
+    const bool air_is_target = block_is_target(NULL_BLOCK);
+
+    // Whether the boundary crossing at time t_a along axis a is
+    // stepped over before that at time t_b along axis b, ties
+    // going to the later axis just as in choosing the axis to
+    // step along below.
+    auto crosses_before = [](f32 t_a, i32 a, f32 t_b, i32 b) {
+        return t_a < t_b || (t_a == t_b && a > b);
+    };
+
+    Chunk* chunk = start_chunk.get();
+
+    std::shared_lock lock(chunk->blocks_mutex);
+
+    BlockWorldPosition previous_position = block_position;
+    f32                previous_distance = 0.0f;
+    f32                block_distance    = 0.0f;
+
+    for (ui32 steps = 0; steps < max_steps; ++steps) {
+        // Step along the axis whose next boundary is nearest.
+        const i32 axis = t_max.x < t_max.y ?
+                            (t_max.x < t_max.z ? 0 : 2) :
+                            (t_max.y < t_max.z ? 1 : 2);
+
+        if constexpr (StopBefore) {
+            previous_position = block_position;
+            previous_distance = block_distance;
+        }
+
+        block_distance  = t_max[axis];
+        t_max[axis]    += t_delta[axis];
+
+        block_position[axis] += step[axis];
+        local_coord[axis]    += step[axis];
+        block_idx            += index_step[axis];
+
+        // Left the chunk, move on to the neighbour entered, found
+        // through the chunk's link to it rather than the grid.
+        if (static_cast<ui32>(local_coord[axis]) >= CHUNK_LENGTH) {
+            lock.unlock();
+
+            // NOTE(Matthew): chunks found through slots live until
+            //                the grid next reclaims slots, which it
+            //                cannot do while we block its thread.
+            chunk = grid.chunk_slots().get(
+                chunk->neighbours.all[exit_neighbour[axis]].load(std::memory_order_acquire)
+            );
+
+            // TODO(Matthew): do we want to allow "seeing through" unloaded chunks?
+            if (chunk == nullptr) return false;
+
+            local_coord[axis] -= step[axis] * CHUNK_LENGTH;
+            block_idx         -= index_step[axis] * CHUNK_LENGTH;
+
+            lock = std::shared_lock(chunk->blocks_mutex);
+        }
+
+        if (!air_is_target) {
+            const i32 level = chunk->blocks.occupancy().empty_level(BlockChunkPosition(local_coord));
+
+            // The block is air, but not part of a cell of air large
+            // enough to be worth jumping over.
+            if (level >= 0 && level < MIN_JUMP_LEVEL) continue;
+
+            if (level >= MIN_JUMP_LEVEL) {
+                /*
+                 * The ray is in a cell of air, so steps on until the
+                 * step that would leave the cell, which is left to
+                 * the next iteration. The k-th boundary crossing
+                 * along each axis from here is at t_max + k * t_delta,
+                 * and so the crossings made before leaving the cell
+                 * can be counted without stepping through them.
+                 */
+                const i32 cell_mask = (1 << level) - 1;
+
+                // Crossings along each axis that stay within the cell,
+                // and the time of the first that does not.
+                i32 in_cell[3] = { 0, 0, 0 };
+                f32 t_leave[3];
+                i32 leave_axis = -1;
+                for (i32 b = 0; b < 3; ++b) {
+                    if (step[b] == 0) continue;
+
+                    const i32 offset = local_coord[b] & cell_mask;
+                    in_cell[b] = step[b] > 0 ? cell_mask - offset : offset;
+                    t_leave[b] = t_max[b] + static_cast<f32>(in_cell[b]) * t_delta[b];
+
+                    if (leave_axis < 0 || crosses_before(t_leave[b], b, t_leave[leave_axis], leave_axis)) {
+                        leave_axis = b;
+                    }
+                }
+
+                if (leave_axis < 0) continue;
+
+                auto crossing_time = [&](i32 b, i32 k) {
+                    return t_max[b] + static_cast<f32>(k) * t_delta[b];
+                };
+
+                // Crossings along each axis made before leaving the
+                // cell, estimated and then corrected such that the
+                // count agrees with crossing_time.
+                i32  crossings[3] = { 0, 0, 0 };
+                ui32 total_crossings = 0;
+                for (i32 b = 0; b < 3; ++b) {
+                    if (step[b] == 0) continue;
+
+                    if (b == leave_axis) {
+                        crossings[b] = in_cell[b];
+                    } else {
+                        const f32 estimate = std::floor((t_leave[leave_axis] - t_max[b]) / t_delta[b]);
+
+                        i32 k = 0;
+                        if (estimate >= static_cast<f32>(in_cell[b])) {
+                            k = in_cell[b];
+                        } else if (estimate > 0.0f) {
+                            k = static_cast<i32>(estimate);
+                        }
+
+                        while (k < in_cell[b] && crosses_before(crossing_time(b, k), b, t_leave[leave_axis], leave_axis)) ++k;
+                        while (k > 0 && !crosses_before(crossing_time(b, k - 1), b, t_leave[leave_axis], leave_axis)) --k;
+
+                        crossings[b] = k;
+                    }
+
+                    total_crossings += static_cast<ui32>(crossings[b]);
+                }
+
+                // The ray ends within the cell, and so hits nothing.
+                if (steps + total_crossings + 1 >= max_steps) return false;
+
+                i32 last_axis = -1;
+                f32 last_t[3];
+                for (i32 b = 0; b < 3; ++b) {
+                    if (crossings[b] == 0) continue;
+
+                    last_t[b] = crossing_time(b, crossings[b] - 1);
+
+                    if (last_axis < 0 || crosses_before(last_t[last_axis], last_axis, last_t[b], b)) {
+                        last_axis = b;
+                    }
+                }
+
+                for (i32 b = 0; b < 3; ++b) {
+                    if (crossings[b] == 0) continue;
+
+                    t_max[b]           = crossing_time(b, crossings[b]);
+                    block_position[b] += step[b] * crossings[b];
+                    local_coord[b]    += step[b] * crossings[b];
+                    block_idx         += index_step[b] * crossings[b];
+                }
+
+                if (last_axis >= 0) block_distance = last_t[last_axis];
+
+                steps += total_crossings;
+
+                continue;
+            }
+        }
+
+        if (block_is_target(chunk->blocks[static_cast<BlockIndex>(block_idx)])) {
+            if constexpr (StopBefore) {
+                position = previous_position;
+                distance = previous_distance;
+            } else {
+                position = block_position;
+                distance = block_distance;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename BlockTestType>
+    requires std::is_invocable_r_v<bool, BlockTestType&, const hvox::Block&>
+bool hvox::Ray::cast_to_block(        f32v3 start,
+                                      f32v3 direction,
+                hmem::WeakHandle<ChunkGrid> grid_handle,
+                              BlockTestType block_is_target,
+                                       ui32 max_steps,
+                    OUT BlockWorldPosition& position,
+                                   OUT f32& distance      )
+{
+    auto chunk_grid = grid_handle.lock();
+
+    if (chunk_grid == nullptr) return false;
+
+    return impl::cast<false>(*chunk_grid, start, direction, block_is_target, max_steps, position, distance);
+}
+
+template <typename BlockTestType>
+    requires std::is_invocable_r_v<bool, BlockTestType&, const hvox::Block&>
+bool hvox::Ray::cast_to_block_before( f32v3 start,
+                                      f32v3 direction,
+                hmem::WeakHandle<ChunkGrid> grid_handle,
+                              BlockTestType block_is_target,
+                                       ui32 max_steps,
+                    OUT BlockWorldPosition& position,
+                                   OUT f32& distance      )
+{
+    auto chunk_grid = grid_handle.lock();
+
+    if (chunk_grid == nullptr) return false;
+
+    return impl::cast<true>(*chunk_grid, start, direction, block_is_target, max_steps, position, distance);
+}
+
+template <typename BlockTestType>
+    requires std::is_invocable_r_v<bool, BlockTestType&, const hvox::Block&>
+void hvox::Ray::cast_many(        const RayCast* rays,
+                                          size_t ray_count,
+                     hmem::WeakHandle<ChunkGrid> grid_handle,
+                                   BlockTestType block_is_target,
+                                     OUT RayHit* hits,
+                              RayCastThreadPool* thread_pool   /*= nullptr*/,
+                                          size_t rays_per_task /*= 256*/ )
+{
+    for (size_t i = 0; i < ray_count; ++i) hits[i].hit = false;
+
+    auto chunk_grid = grid_handle.lock();
+
+    if (chunk_grid == nullptr || ray_count == 0) return;
+
+    if (rays_per_task == 0) rays_per_task = 1;
+
+    // The calling thread casts the first range of rays itself,
+    // and all of them if there is no thread pool to share with.
+    const size_t own_rays   = thread_pool == nullptr ? ray_count : std::min(ray_count, rays_per_task);
+    const size_t task_count = (ray_count - own_rays + rays_per_task - 1) / rays_per_task;
+
+    auto batch = std::make_shared<impl::RayCastBatch<BlockTestType>>(
+        chunk_grid.get(), rays, hits, block_is_target, task_count
+    );
+
+    if (task_count > 0) {
+        std::vector<thread::HeldTask<thread::BasicThreadContext>> tasks;
+        tasks.reserve(task_count);
+
+        for (size_t first = own_rays; first < ray_count; first += rays_per_task) {
+            tasks.emplace_back(thread::HeldTask<thread::BasicThreadContext>{
+                new impl::RayCastTask<BlockTestType>(batch, first, std::min(ray_count, first + rays_per_task)),
+                true
+            });
+        }
+
+        thread_pool->add_tasks(tasks.data(), tasks.size());
+    }
+
+    impl::cast_range(*batch, 0, own_rays);
+
+    size_t remaining_tasks;
+    while ((remaining_tasks = batch->remaining_tasks.load(std::memory_order_acquire)) != 0) {
+        batch->remaining_tasks.wait(remaining_tasks, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,44 @@
+#include "stdafx.h"
+
+#include "camera/frustum.h"
+
+void hcam::Frustum::update(const f32m4& view_projection) {
+    // Rows of the matrix, glm being column-major.
+    f32v4 rows[4];
+    for (ui32 i = 0; i < 4; ++i) {
+        rows[i] = f32v4{
+            view_projection[0][i],
+            view_projection[1][i],
+            view_projection[2][i],
+            view_projection[3][i]
+        };
+    }
+
+    // Left, right, bottom, top, near and far, in that order.
+    m_planes[0] = rows[3] + rows[0];
+    m_planes[1] = rows[3] - rows[0];
+    m_planes[2] = rows[3] + rows[1];
+    m_planes[3] = rows[3] - rows[1];
+    m_planes[4] = rows[3] + rows[2];
+    m_planes[5] = rows[3] - rows[2];
+
+    for (auto& plane : m_planes) {
+        plane /= glm::length(f32v3{plane});
+    }
+}
+
+bool hcam::Frustum::intersects(const f32v3& min, const f32v3& max) const {
+    for (const auto& plane : m_planes) {
+        // The corner of the box furthest along the plane's
+        // normal, if that is outside then all of the box is.
+        f32v3 corner = f32v3{
+            plane.x >= 0.0f ? max.x : min.x,
+            plane.y >= 0.0f ? max.y : min.y,
+            plane.z >= 0.0f ? max.z : min.z
+        };
+
+        if (glm::dot(f32v3{plane}, corner) + plane.w < 0.0f) return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,156 @@
+#include "stdafx.h"
+
+#include "physics/task_scheduler.h"
+
+namespace hemlock {
+    namespace physics {
+        class ParallelWorkTask : public thread::IThreadTask<thread::BasicThreadContext> {
+        public:
+            ParallelWorkTask(hmem::Handle<ParallelWork> work) :
+                m_work(work)
+            { /* Empty. */ }
+            virtual ~ParallelWorkTask() { /* Empty. */ }
+
+            virtual void execute(
+                thread::Thread<thread::BasicThreadContext>::State*,
+                thread::TaskQueue<thread::BasicThreadContext>*
+            ) override {
+                m_work->run();
+            }
+        protected:
+            hmem::Handle<ParallelWork> m_work;
+        };
+    }
+}
+
+void hphys::ParallelWork::run() {
+    while (true) {
+        const int grain_begin = next.fetch_add(grain_size, std::memory_order_relaxed);
+        if (grain_begin >= end) return;
+
+        const int grain_end = std::min(grain_begin + grain_size, end);
+
+        if (for_body) {
+            for_body->forLoop(grain_begin, grain_end);
+        } else {
+            sum.fetch_add(sum_body->sumLoop(grain_begin, grain_end), std::memory_order_relaxed);
+        }
+
+        // NOTE(Matthew): the work is held by handle by whoever runs
+        //                it, so may be notified through safely once
+        //                the last grain is done.
+        const int grain_length = grain_end - grain_begin;
+        if (remaining.fetch_sub(grain_length, std::memory_order_acq_rel) == grain_length)
+            remaining.notify_all();
+    }
+}
+
+hphys::ThreadPoolTaskScheduler::ThreadPoolTaskScheduler() :
+    btITaskScheduler("ThreadPoolTaskScheduler"),
+    m_pool_thread_count(0),
+    m_thread_count(1),
+    m_running(false)
+{ /* Empty. */ }
+
+void hphys::ThreadPoolTaskScheduler::init(ui32 thread_count) {
+    m_pool_thread_count = thread_count;
+    m_thread_count      = thread_count + 1;
+
+    m_thread_pool.init(thread_count);
+}
+
+void hphys::ThreadPoolTaskScheduler::dispose() {
+    m_thread_pool.dispose();
+
+    m_pool_thread_count = 0;
+    m_thread_count      = 1;
+}
+
+void hphys::ThreadPoolTaskScheduler::setNumThreads(int thread_count) {
+    m_thread_count = static_cast<ui32>(
+        std::clamp(thread_count, 1, static_cast<int>(m_pool_thread_count) + 1)
+    );
+}
+
+void hphys::ThreadPoolTaskScheduler::parallelFor(
+                          int  begin,
+                          int  end,
+                          int  grain_size,
+    const btIParallelForBody&  body
+) {
+    if (begin >= end) return;
+
+    auto work = hmem::make_handle<ParallelWork>();
+    work->next          = begin;
+    work->end           = end;
+    work->grain_size    = std::max(grain_size, 1);
+    work->remaining     = end - begin;
+    work->for_body      = &body;
+    work->sum_body      = nullptr;
+    work->sum           = 0.0f;
+
+    run(work);
+}
+
+btScalar hphys::ThreadPoolTaskScheduler::parallelSum(
+                          int  begin,
+                          int  end,
+                          int  grain_size,
+    const btIParallelSumBody&  body
+) {
+    if (begin >= end) return 0.0f;
+
+    auto work = hmem::make_handle<ParallelWork>();
+    work->next          = begin;
+    work->end           = end;
+    work->grain_size    = std::max(grain_size, 1);
+    work->remaining     = end - begin;
+    work->for_body      = nullptr;
+    work->sum_body      = &body;
+    work->sum           = 0.0f;
+
+    run(work);
+
+    return work->sum.load(std::memory_order_relaxed);
+}
+
+void hphys::ThreadPoolTaskScheduler::run(hmem::Handle<ParallelWork> work) {
+    // Loops within loops, or on threads other than the one already
+    // in a loop, are run inline, as only one thread may add tasks to
+    // the pool and any tasks added would wait on the pool's threads
+    // which are busy with the outer loop.
+    if (m_running.exchange(true, std::memory_order_acquire)) {
+        work->run();
+        return;
+    }
+
+    // No more tasks are added than there are grains of work to take,
+    // bar the grain taken by this thread.
+    const int grain_count = (work->end - work->next.load(std::memory_order_relaxed) + work->grain_size - 1) / work->grain_size;
+    const ui32 task_count = static_cast<ui32>(
+        std::clamp(grain_count - 1, 0, static_cast<int>(m_thread_count) - 1)
+    );
+
+    if (task_count > 0) {
+        std::vector<thread::HeldTask<thread::BasicThreadContext>> tasks;
+        tasks.reserve(task_count);
+        for (ui32 i = 0; i < task_count; ++i) {
+            tasks.emplace_back(thread::HeldTask<thread::BasicThreadContext>{
+                new ParallelWorkTask(work), true
+            });
+        }
+
+        m_thread_pool.add_tasks(tasks.data(), tasks.size());
+    }
+
+    work->run();
+
+    // The last grains may still be running on the pool's threads,
+    // wait on them without spinning so as to leave the core free.
+    int remaining;
+    while ((remaining = work->remaining.load(std::memory_order_acquire)) != 0) {
+        work->remaining.wait(remaining, std::memory_order_acquire);
+    }
+
+    m_running.store(false, std::memory_order_release);
+}
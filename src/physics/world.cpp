@@ -0,0 +1,75 @@
+#include "stdafx.h"
+
+#include "physics/world.h"
+
+hphys::PhysicsWorld::PhysicsWorld() :
+    m_broadphase(nullptr),
+    m_collision_config(nullptr),
+    m_dispatcher(nullptr),
+    m_solver_pool(nullptr),
+    m_world(nullptr),
+    m_fixed_time_step(1.0f / 60.0f),
+    m_max_sub_steps(4)
+{ /* Empty. */ }
+
+void hphys::PhysicsWorld::init(      ui32 thread_count,
+                                 btScalar fixed_time_step /*= 1.0f / 60.0f*/,
+                                     ui32 max_sub_steps   /*= 4*/ )
+{
+    m_fixed_time_step = fixed_time_step;
+    m_max_sub_steps   = max_sub_steps;
+
+    m_task_scheduler.init(thread_count);
+    btSetTaskScheduler(&m_task_scheduler);
+
+    // NOTE(Matthew): the pools of manifolds and collision algorithms
+    //                are made larger than by default, as running out
+    //                of them falls back on allocations which are all
+    //                the more costly across threads.
+    btDefaultCollisionConstructionInfo collision_info;
+    collision_info.m_defaultMaxPersistentManifoldPoolSize = 80000;
+    collision_info.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+
+    m_broadphase        = new btDbvtBroadphase();
+    m_collision_config  = new btDefaultCollisionConfiguration(collision_info);
+    m_dispatcher        = new btCollisionDispatcherMt(m_collision_config);
+    // One solver per thread, such that each island being solved at
+    // once has a solver to itself.
+    m_solver_pool       = new btConstraintSolverPoolMt(static_cast<int>(thread_count) + 1);
+    m_world             = new btDiscreteDynamicsWorldMt(
+                            m_dispatcher,
+                            m_broadphase,
+                            m_solver_pool,
+                            nullptr,
+                            m_collision_config
+                        );
+}
+
+void hphys::PhysicsWorld::dispose() {
+    delete m_world;
+    m_world = nullptr;
+
+    delete m_solver_pool;
+    m_solver_pool = nullptr;
+
+    delete m_dispatcher;
+    m_dispatcher = nullptr;
+
+    delete m_collision_config;
+    m_collision_config = nullptr;
+
+    delete m_broadphase;
+    m_broadphase = nullptr;
+
+    if (btGetTaskScheduler() == &m_task_scheduler) btSetTaskScheduler(btGetSequentialTaskScheduler());
+
+    m_task_scheduler.dispose();
+}
+
+void hphys::PhysicsWorld::step(FrameTime time) {
+    m_world->stepSimulation(
+        frame_time_to_floating<std::chrono::seconds, btScalar>(time),
+        static_cast<int>(m_max_sub_steps),
+        m_fixed_time_step
+    );
+}
@@ -5,17 +5,23 @@
 #include "voxel/chunk.h"
 
 hvox::Chunk::Chunk() :
+    slot({ 0, 0 }),
     neighbours({}),
-    blocks(nullptr),
+    render_state(RenderState::FULL),
     state(ChunkState::NONE),
-    pending_task(ChunkTaskKind::NONE)
+    pending_task(ChunkTaskKind::NONE),
+    alive_state(ChunkAliveState::ALIVE),
+    mesh_epoch(0),
+    mesh_empty(true),
+    modified(true),
+    ungenerated_neighbour_count(0),
+    generation_seen(false)
 { /* Empty. */ }
 
 hvox::Chunk::~Chunk() {
     // debug_printf("Unloading chunk at (%d, %d, %d).\n", position.x, position.y, position.z);
 
-    m_block_pager->free_page(blocks);
-    blocks = nullptr;
+    blocks.dispose();
 
     instance.dispose();
 
@@ -24,15 +30,15 @@ hvox::Chunk::~Chunk() {
 
 void hvox::Chunk::init(
                  hmem::WeakHandle<Chunk> self,
-           hmem::Handle<ChunkBlockPager> block_pager,
-    hmem::Handle<ChunkInstanceDataPager> instance_data_pager
+    hmem::Handle<ChunkInstanceDataPager> instance_data_pager,
+        hmem::Handle<ChunkQuadDataPager> quad_data_pager,
+        hmem::Handle<ChunkStagingBuffer> staging_buffer /*= nullptr*/
 ) {
     init_events(self);
 
-    blocks = block_pager->get_page();
-    m_block_pager = block_pager;
+    blocks.init();
 
-    instance.init(instance_data_pager);
+    instance.init(instance_data_pager, quad_data_pager, staging_buffer);
 
     neighbours = {};
 
@@ -46,6 +52,8 @@ void hvox::Chunk::update(FrameTime) {
 void hvox::Chunk::init_events(hmem::WeakHandle<Chunk> self) {
     on_block_change         .set_sender(Sender(self));
     on_bulk_block_change    .set_sender(Sender(self));
+    on_block_changed        .set_sender(Sender(self));
+    on_bulk_block_changed   .set_sender(Sender(self));
     on_load                 .set_sender(Sender(self));
     on_mesh_change          .set_sender(Sender(self));
     on_render_state_change  .set_sender(Sender(self));
@@ -58,14 +66,18 @@ bool hvox::set_block( hmem::Handle<Chunk> chunk,
 {
     auto block_idx = block_index(block_position);
 
+    bool  gen_task_active;
+    Block old_block;
     {
         std::shared_lock lock(chunk->blocks_mutex);
 
-        bool gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
+        old_block = chunk->blocks[block_idx];
+
+        gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
         if (!gen_task_active) {
             bool should_cancel = chunk->on_block_change({
                 chunk,
-                chunk->blocks[block_idx],
+                old_block,
                 block,
                 block_position
             });
@@ -73,9 +85,20 @@ bool hvox::set_block( hmem::Handle<Chunk> chunk,
         }
     }
 
-    std::lock_guard lock(chunk->blocks_mutex);
+    {
+        std::lock_guard lock(chunk->blocks_mutex);
 
-    chunk->blocks[block_idx] = block;
+        chunk->blocks.set(block_idx, block);
+    }
+
+    if (!gen_task_active && old_block != block) {
+        chunk->on_block_changed({
+            chunk,
+            old_block,
+            block,
+            block_position
+        });
+    }
 
     return true;
 }
@@ -85,10 +108,11 @@ bool hvox::set_blocks( hmem::Handle<Chunk> chunk,
                         BlockChunkPosition end_block_position,
                                      Block block )
 {
+    bool gen_task_active;
     {
         std::shared_lock lock(chunk->blocks_mutex);
 
-        bool gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
+        gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
         if (!gen_task_active) {
             bool should_cancel = chunk->on_bulk_block_change({
                 chunk,
@@ -101,14 +125,26 @@ bool hvox::set_blocks( hmem::Handle<Chunk> chunk,
         }
     }
 
-    std::lock_guard lock(chunk->blocks_mutex);
+    {
+        std::lock_guard lock(chunk->blocks_mutex);
+
+        set_per_block_data(
+            chunk->blocks,
+            start_block_position,
+            end_block_position,
+            block
+        );
+    }
 
-    set_per_block_data(
-        chunk->blocks,
-        start_block_position,
-        end_block_position,
-        block
-    );
+    if (!gen_task_active) {
+        chunk->on_bulk_block_changed({
+            chunk,
+            &block,
+            true,
+            start_block_position,
+            end_block_position
+        });
+    }
 
     return true;
 }
@@ -118,10 +154,11 @@ bool hvox::set_blocks( hmem::Handle<Chunk> chunk,
                         BlockChunkPosition end_block_position,
                                     Block* blocks )
 {
+    bool gen_task_active;
     {
         std::shared_lock lock(chunk->blocks_mutex);
 
-        bool gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
+        gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
         if (!gen_task_active) {
             bool should_cancel = chunk->on_bulk_block_change({
                 chunk,
@@ -134,14 +171,42 @@ bool hvox::set_blocks( hmem::Handle<Chunk> chunk,
         }
     }
 
-    std::lock_guard lock(chunk->blocks_mutex);
+    {
+        std::lock_guard lock(chunk->blocks_mutex);
+
+        set_per_block_data(
+            chunk->blocks,
+            start_block_position,
+            end_block_position,
+            blocks
+        );
+    }
 
-    set_per_block_data(
-        chunk->blocks,
-        start_block_position,
-        end_block_position,
-        blocks
-    );
+    if (!gen_task_active) {
+        chunk->on_bulk_block_changed({
+            chunk,
+            blocks,
+            false,
+            start_block_position,
+            end_block_position
+        });
+    }
 
     return true;
 }
+
+void hvox::set_per_block_data( ChunkBlockStorage& storage,
+                              BlockChunkPosition start_block_position,
+                              BlockChunkPosition end_block_position,
+                                           Block block )
+{
+    storage.fill(start_block_position, end_block_position, block);
+}
+
+void hvox::set_per_block_data( ChunkBlockStorage& storage,
+                              BlockChunkPosition start_block_position,
+                              BlockChunkPosition end_block_position,
+                                          Block* blocks )
+{
+    storage.copy(start_block_position, end_block_position, blocks);
+}
@@ -0,0 +1,479 @@
+#include "stdafx.h"
+
+#include "voxel/chunk/block_storage.h"
+
+static inline ui8 required_index_bits(size_t palette_size) {
+    // Indices are at most 16 bits wide, it is on callers to
+    // compact the palette before it outgrows them.
+    assert(palette_size <= (size_t{1} << 16));
+
+    if (palette_size <= 1)   return 0;
+    if (palette_size <= 2)   return 1;
+    if (palette_size <= 4)   return 2;
+    if (palette_size <= 16)  return 4;
+    if (palette_size <= 256) return 8;
+    return 16;
+}
+
+static inline ui8 index_bits_log2(ui8 index_bits) {
+    switch (index_bits) {
+        case 1:  return 0;
+        case 2:  return 1;
+        case 4:  return 2;
+        case 8:  return 3;
+        case 16: return 4;
+        default: return 0;
+    }
+}
+
+/*
+ * Mask of the faces of the chunk the block at the given index
+ * lies on, bit i being set for the face whose BlockFace value
+ * is i - left, right, bottom, top, front then back.
+ */
+static inline ui8 faces_of(hvox::BlockIndex index) {
+    const hvox::BlockIndex x = index % CHUNK_LENGTH;
+    const hvox::BlockIndex y = (index / CHUNK_LENGTH) % CHUNK_LENGTH;
+    const hvox::BlockIndex z = index / (CHUNK_AREA);
+
+    ui8 faces = 0;
+    if (x == 0)                faces |= 1 << 0;
+    if (x == CHUNK_LENGTH - 1) faces |= 1 << 1;
+    if (y == 0)                faces |= 1 << 2;
+    if (y == CHUNK_LENGTH - 1) faces |= 1 << 3;
+    if (z == 0)                faces |= 1 << 4;
+    if (z == CHUNK_LENGTH - 1) faces |= 1 << 5;
+
+    return faces;
+}
+
+/*
+ * Indices are a power of two bits wide, so never straddle the
+ * 64-bit words they are packed into.
+ */
+static inline ui32 read_index(const ui64* words, ui8 bits_log2, hvox::BlockIndex index) {
+    const ui32 per_word_log2 = 6u - bits_log2;
+
+    const ui32 word  = index >> per_word_log2;
+    const ui32 shift = (index & ((1u << per_word_log2) - 1u)) << bits_log2;
+    const ui64 mask  = (ui64{1} << (1u << bits_log2)) - 1u;
+
+    return static_cast<ui32>((words[word] >> shift) & mask);
+}
+
+static inline void write_index(ui64* words, ui8 bits_log2, hvox::BlockIndex index, ui32 palette_idx) {
+    const ui32 per_word_log2 = 6u - bits_log2;
+
+    const ui32 word  = index >> per_word_log2;
+    const ui32 shift = (index & ((1u << per_word_log2) - 1u)) << bits_log2;
+    const ui64 mask  = (ui64{1} << (1u << bits_log2)) - 1u;
+
+    words[word] = (words[word] & ~(mask << shift))
+                    | ((static_cast<ui64>(palette_idx) & mask) << shift);
+}
+
+hvox::ChunkBlockStorage::ChunkBlockStorage() :
+    m_palette({ NULL_BLOCK }),
+    m_indices(nullptr),
+    m_index_bits(0),
+    m_index_bits_log2(0),
+    m_solid_count(0),
+    m_face_solid_counts{0, 0, 0, 0, 0, 0}
+{ /* Empty. */ }
+
+hvox::ChunkBlockStorage::~ChunkBlockStorage() {
+    dispose();
+}
+
+void hvox::ChunkBlockStorage::init(Block block /*= NULL_BLOCK*/) {
+    fill(block);
+}
+
+void hvox::ChunkBlockStorage::dispose() {
+    delete[] m_indices;
+    m_indices = nullptr;
+
+    m_index_bits      = 0;
+    m_index_bits_log2 = 0;
+
+    std::vector<Block>{ NULL_BLOCK }.swap(m_palette);
+
+    reset_occupancy(NULL_BLOCK);
+}
+
+hvox::Block hvox::ChunkBlockStorage::get(BlockIndex index) const {
+    if (is_uniform()) return m_palette[0];
+
+    return m_palette[index_at(index)];
+}
+
+void hvox::ChunkBlockStorage::set(BlockIndex index, Block block) {
+    if (is_uniform() && m_palette[0] == block) return;
+
+    const Block old_block = get(index);
+
+    set_index_at(index, palette_index(block));
+
+    track_occupancy(index, old_block, block);
+
+    collapse_if_uniform();
+}
+
+void hvox::ChunkBlockStorage::fill(Block block) {
+    delete[] m_indices;
+    m_indices = nullptr;
+
+    m_index_bits      = 0;
+    m_index_bits_log2 = 0;
+
+    m_palette.clear();
+    m_palette.emplace_back(block);
+
+    reset_occupancy(block);
+}
+
+void hvox::ChunkBlockStorage::fill(BlockChunkPosition start, BlockChunkPosition end, Block block) {
+    /*
+     * If we span the whole chunk, we simply become uniform.
+     */
+    if (start == BlockChunkPosition{0} && end == BlockChunkPosition{CHUNK_LENGTH - 1}) {
+        fill(block);
+        return;
+    }
+
+    if (is_uniform() && m_palette[0] == block) return;
+
+    ui32 palette_idx = palette_index(block);
+
+    for (BlockChunkPositionCoord z = start.z; z <= end.z; ++z) {
+        for (BlockChunkPositionCoord y = start.y; y <= end.y; ++y) {
+            BlockIndex row_idx = block_index({ start.x, y, z });
+            for (BlockIndex x = 0; x <= static_cast<BlockIndex>(end.x - start.x); ++x) {
+                track_occupancy(row_idx + x, m_palette[index_at(row_idx + x)], block);
+
+                set_index_at(row_idx + x, palette_idx);
+            }
+        }
+    }
+
+    collapse_if_uniform();
+}
+
+void hvox::ChunkBlockStorage::copy(BlockChunkPosition start, BlockChunkPosition end, const Block* blocks) {
+    /*
+     * If we span the whole chunk, we start over from the first
+     * block so that no stale palette entries are retained, and
+     * build the occupancy pyramid in bulk once done.
+     */
+    const bool whole_chunk = start == BlockChunkPosition{0} && end == BlockChunkPosition{CHUNK_LENGTH - 1};
+    if (whole_chunk) {
+        fill(blocks[0]);
+    }
+
+    // Cache the last looked-up block, runs of identical blocks
+    // are by far the common case.
+    Block last_block  = m_palette[0];
+    ui32  palette_idx = 0;
+
+    size_t buffer_idx = 0;
+    for (BlockChunkPositionCoord z = start.z; z <= end.z; ++z) {
+        for (BlockChunkPositionCoord y = start.y; y <= end.y; ++y) {
+            BlockIndex row_idx = block_index({ start.x, y, z });
+            for (BlockIndex x = 0; x <= static_cast<BlockIndex>(end.x - start.x); ++x) {
+                const Block& block = blocks[buffer_idx++];
+
+                if (is_uniform() && m_palette[0] == block) continue;
+
+                if (block != last_block || is_uniform()) {
+                    palette_idx = palette_index(block);
+                    last_block  = block;
+                }
+
+                track_occupancy(row_idx + x, m_palette[index_at(row_idx + x)], block, !whole_chunk);
+
+                set_index_at(row_idx + x, palette_idx);
+            }
+        }
+    }
+
+    if (whole_chunk) m_occupancy.rebuild();
+
+    collapse_if_uniform();
+}
+
+void hvox::ChunkBlockStorage::unpack(Block* buffer) const {
+    if (is_uniform()) {
+        std::fill_n(buffer, CHUNK_VOLUME, m_palette[0]);
+        return;
+    }
+
+    for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
+        buffer[i] = m_palette[index_at(i)];
+    }
+}
+
+/*
+ * Serialised layout, all in native byte order:
+ *     ui8  index bits
+ *     ui32 palette size
+ *     ui64 palette block IDs  [palette size]
+ *     ui64 packed index words [word count for index bits]
+ */
+void hvox::ChunkBlockStorage::serialise(OUT std::vector<ui8>& buffer) const {
+    const ui32   palette_size = static_cast<ui32>(m_palette.size());
+    const size_t words        = is_uniform() ? 0 : word_count(m_index_bits);
+
+    size_t offset = buffer.size();
+    buffer.resize(
+        offset + sizeof(ui8) + sizeof(ui32)
+            + palette_size * sizeof(BlockID) + words * sizeof(ui64)
+    );
+
+    ui8* cursor = &buffer[offset];
+
+    *cursor = m_index_bits;
+    cursor += sizeof(ui8);
+
+    std::memcpy(cursor, &palette_size, sizeof(ui32));
+    cursor += sizeof(ui32);
+
+    for (const auto& block : m_palette) {
+        std::memcpy(cursor, &block.id, sizeof(BlockID));
+        cursor += sizeof(BlockID);
+    }
+
+    if (words > 0) std::memcpy(cursor, m_indices, words * sizeof(ui64));
+}
+
+bool hvox::ChunkBlockStorage::deserialise(const ui8* data, size_t length) {
+    if (length < sizeof(ui8) + sizeof(ui32)) return false;
+
+    ui8 index_bits = *data;
+    switch (index_bits) {
+        case 0: case 1: case 2: case 4: case 8: case 16:
+            break;
+        default:
+            return false;
+    }
+
+    ui32 palette_size;
+    std::memcpy(&palette_size, data + sizeof(ui8), sizeof(ui32));
+
+    if (palette_size == 0) return false;
+    // Checked before anything else is made of the palette size, as
+    // no more than this many entries can be indexed.
+    if (palette_size > (1u << 16)) return false;
+    if (required_index_bits(palette_size) > index_bits) return false;
+
+    const size_t words    = index_bits == 0 ? 0 : word_count(index_bits);
+    const size_t expected = sizeof(ui8) + sizeof(ui32)
+                                + palette_size * sizeof(BlockID) + words * sizeof(ui64);
+    if (length < expected) return false;
+
+    const ui8* cursor = data + sizeof(ui8) + sizeof(ui32);
+
+    std::vector<Block> palette(palette_size);
+    for (auto& block : palette) {
+        std::memcpy(&block.id, cursor, sizeof(BlockID));
+        cursor += sizeof(BlockID);
+    }
+
+    ui64* indices = nullptr;
+    if (words > 0) {
+        indices = new ui64[words];
+        std::memcpy(indices, cursor, words * sizeof(ui64));
+
+        // Every index must refer to an entry of the palette, else
+        // lookups would read past its end.
+        const ui8 bits_log2 = index_bits_log2(index_bits);
+        for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
+            if (read_index(indices, bits_log2, i) >= palette_size) {
+                delete[] indices;
+                return false;
+            }
+        }
+    }
+
+    delete[] m_indices;
+
+    m_palette.swap(palette);
+    m_indices         = indices;
+    m_index_bits      = index_bits;
+    m_index_bits_log2 = index_bits_log2(index_bits);
+
+    if (is_uniform()) {
+        reset_occupancy(m_palette[0]);
+    } else {
+        reset_occupancy(NULL_BLOCK);
+
+        for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
+            track_occupancy(i, NULL_BLOCK, m_palette[index_at(i)], false);
+        }
+
+        m_occupancy.rebuild();
+
+        collapse_if_uniform();
+    }
+
+    return true;
+}
+
+void hvox::ChunkBlockStorage::compact() {
+    if (is_uniform()) return;
+
+    std::vector<ui32> remap(m_palette.size(), std::numeric_limits<ui32>::max());
+    std::vector<ui16> decoded(CHUNK_VOLUME);
+
+    std::vector<Block> palette;
+    palette.reserve(m_palette.size());
+
+    for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
+        ui32 old_idx = index_at(i);
+
+        if (remap[old_idx] == std::numeric_limits<ui32>::max()) {
+            remap[old_idx] = static_cast<ui32>(palette.size());
+            palette.emplace_back(m_palette[old_idx]);
+        }
+
+        decoded[i] = static_cast<ui16>(remap[old_idx]);
+    }
+
+    // Nothing to drop.
+    if (palette.size() == m_palette.size()) return;
+
+    if (palette.size() == 1) {
+        fill(palette[0]);
+        return;
+    }
+
+    delete[] m_indices;
+
+    m_palette.swap(palette);
+
+    m_index_bits      = required_index_bits(m_palette.size());
+    m_index_bits_log2 = index_bits_log2(m_index_bits);
+    m_indices         = new ui64[word_count(m_index_bits)]{};
+
+    for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
+        set_index_at(i, decoded[i]);
+    }
+}
+
+size_t hvox::ChunkBlockStorage::memory_usage() const {
+    return m_palette.capacity() * sizeof(Block)
+            + (m_indices ? word_count(m_index_bits) * sizeof(ui64) : 0)
+            + m_occupancy.memory_usage();
+}
+
+ui8 hvox::ChunkBlockStorage::solid_faces() const {
+    ui8 faces = 0;
+    for (ui8 face = 0; face < 6; ++face) {
+        if (m_face_solid_counts[face] == (CHUNK_AREA)) faces |= static_cast<ui8>(1 << face);
+    }
+
+    return faces;
+}
+
+ui32 hvox::ChunkBlockStorage::palette_index(Block block) {
+    for (ui32 i = 0; i < m_palette.size(); ++i) {
+        if (m_palette[i] == block) return i;
+    }
+
+    // Palette entries are otherwise never dropped, so before
+    // indices are widened to make room for another, drop any
+    // that are no longer referenced. This also keeps the
+    // palette within the reach of 16-bit indices.
+    if (!is_uniform() && m_palette.size() + 1 > (size_t{1} << m_index_bits)) compact();
+
+    m_palette.emplace_back(block);
+
+    ui8 index_bits = required_index_bits(m_palette.size());
+    if (index_bits > m_index_bits) repack(index_bits);
+
+    return static_cast<ui32>(m_palette.size() - 1);
+}
+
+void hvox::ChunkBlockStorage::repack(ui8 index_bits) {
+    ui64* indices   = new ui64[word_count(index_bits)]{};
+    ui8   bits_log2 = index_bits_log2(index_bits);
+
+    // A uniform chunk has every voxel at palette index
+    // zero, which a zeroed buffer already represents.
+    if (!is_uniform()) {
+        for (BlockIndex i = 0; i < CHUNK_VOLUME; ++i) {
+            write_index(indices, bits_log2, i, read_index(m_indices, m_index_bits_log2, i));
+        }
+    }
+
+    delete[] m_indices;
+
+    m_indices         = indices;
+    m_index_bits      = index_bits;
+    m_index_bits_log2 = bits_log2;
+}
+
+ui32 hvox::ChunkBlockStorage::index_at(BlockIndex index) const {
+    return read_index(m_indices, m_index_bits_log2, index);
+}
+
+void hvox::ChunkBlockStorage::set_index_at(BlockIndex index, ui32 palette_idx) {
+    write_index(m_indices, m_index_bits_log2, index, palette_idx);
+}
+
+void hvox::ChunkBlockStorage::track_occupancy(BlockIndex index, Block old_block, Block block, bool propagate /*= true*/) {
+    const bool was_solid = old_block != NULL_BLOCK;
+    const bool is_solid  = block     != NULL_BLOCK;
+
+    if (was_solid == is_solid) return;
+
+    if (propagate) {
+        m_occupancy.set(index, is_solid);
+    } else {
+        m_occupancy.set_unpropagated(index, is_solid);
+    }
+
+    const ui8 faces = faces_of(index);
+
+    if (is_solid) {
+        ++m_solid_count;
+        for (ui8 face = 0; face < 6; ++face) {
+            if (faces & (1 << face)) ++m_face_solid_counts[face];
+        }
+    } else {
+        --m_solid_count;
+        for (ui8 face = 0; face < 6; ++face) {
+            if (faces & (1 << face)) --m_face_solid_counts[face];
+        }
+    }
+}
+
+void hvox::ChunkBlockStorage::reset_occupancy(Block block) {
+    const bool solid = block != NULL_BLOCK;
+
+    m_occupancy.fill(solid);
+
+    m_solid_count = solid ? (CHUNK_VOLUME) : 0;
+    for (auto& count : m_face_solid_counts) {
+        count = solid ? (CHUNK_AREA) : 0;
+    }
+}
+
+void hvox::ChunkBlockStorage::collapse_if_uniform() {
+    if (is_uniform()) return;
+
+    if (is_empty()) {
+        fill(NULL_BLOCK);
+        return;
+    }
+
+    // With every block solid, NULL_BLOCK is referenced by no
+    // voxel, so a palette of it and one other block means the
+    // chunk is made up of that other block alone.
+    if (is_full() && m_palette.size() == 2) {
+        if (m_palette[0] == NULL_BLOCK) {
+            fill(m_palette[1]);
+        } else if (m_palette[1] == NULL_BLOCK) {
+            fill(m_palette[0]);
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#include "stdafx.h"
+
+#include "voxel/chunk.h"
+#include "voxel/chunk/grid.h"
+
+#include "voxel/chunk/edit_batch.h"
+
+void hvox::BlockEditBatch::set_block(BlockWorldPosition position, Block block) {
+    m_edits.emplace_back(Edit{
+        chunk_grid_position(position).id,
+        block_index(block_chunk_position(position)),
+        block
+    });
+}
+
+void hvox::BlockEditBatch::set_blocks(BlockWorldPosition start, BlockWorldPosition end, Block block) {
+    const BlockWorldPosition lower = glm::min(start, end);
+    const BlockWorldPosition upper = glm::max(start, end);
+
+    m_edits.reserve(
+        m_edits.size()
+            + static_cast<size_t>(upper.x - lower.x + 1)
+            * static_cast<size_t>(upper.y - lower.y + 1)
+            * static_cast<size_t>(upper.z - lower.z + 1)
+    );
+
+    for (BlockWorldPositionCoord z = lower.z; z <= upper.z; ++z) {
+        for (BlockWorldPositionCoord y = lower.y; y <= upper.y; ++y) {
+            for (BlockWorldPositionCoord x = lower.x; x <= upper.x; ++x) {
+                set_block({ x, y, z }, block);
+            }
+        }
+    }
+}
+
+bool hvox::BlockEditBatch::commit(hmem::WeakHandle<ChunkGrid> grid_handle) {
+    auto grid = grid_handle.lock();
+    if (grid == nullptr) {
+        m_edits.clear();
+        return false;
+    }
+
+    /*
+     * Sorting by chunk groups the edits of each chunk together,
+     * and by block index within a chunk puts them in the order
+     * blocks are laid out in, x then y then z. The sort is stable
+     * so that of edits to the same block the last added is last.
+     */
+    std::stable_sort(m_edits.begin(), m_edits.end(), [](const Edit& lhs, const Edit& rhs) {
+        if (lhs.chunk_id != rhs.chunk_id) return lhs.chunk_id < rhs.chunk_id;
+
+        return lhs.block_index < rhs.block_index;
+    });
+
+    // Drop all but the last of the edits to each block.
+    size_t kept = 0;
+    for (size_t i = 0; i < m_edits.size(); ++i) {
+        if (i + 1 < m_edits.size()
+                && m_edits[i].chunk_id    == m_edits[i + 1].chunk_id
+                && m_edits[i].block_index == m_edits[i + 1].block_index) continue;
+
+        m_edits[kept++] = m_edits[i];
+    }
+    m_edits.resize(kept);
+
+    bool all_applied = true;
+
+    // Blocks of the bounding box of a chunk's edits as they will
+    // be once the edits are applied, reused between chunks.
+    std::vector<Block> blocks;
+
+    // NOTE(Matthew): each chunk is locked alone, and in order of ID,
+    //                as mesh tasks lock a chunk and then its neighbours,
+    //                and so holding the locks of many chunks at once
+    //                could deadlock.
+    for (size_t first = 0, last = 0; first < m_edits.size(); first = last) {
+        while (last < m_edits.size() && m_edits[last].chunk_id == m_edits[first].chunk_id) ++last;
+
+        auto chunk = grid->chunk(m_edits[first].chunk_id);
+        if (chunk == nullptr) continue;
+
+        BlockChunkPosition start = block_chunk_position(m_edits[first].block_index);
+        BlockChunkPosition end   = start;
+        for (size_t i = first + 1; i < last; ++i) {
+            BlockChunkPosition position = block_chunk_position(m_edits[i].block_index);
+
+            start = glm::min(start, position);
+            end   = glm::max(end,   position);
+        }
+
+        const size_t width  = static_cast<size_t>(end.x - start.x + 1);
+        const size_t height = static_cast<size_t>(end.y - start.y + 1);
+        const size_t depth  = static_cast<size_t>(end.z - start.z + 1);
+
+        // Whether the edits fill their bounding box.
+        const bool dense = width * height * depth == last - first;
+
+        blocks.resize(width * height * depth);
+
+        bool gen_task_active;
+        {
+            // The buffer is filled, the change announced and the edits
+            // applied under the one lock, such that the blocks handed
+            // to subscribers are those that are written.
+            std::lock_guard lock(chunk->blocks_mutex);
+
+            if (dense) {
+                // Edits are sorted in the order the bounding box is
+                // laid out in, and cover all of it.
+                for (size_t i = first; i < last; ++i) {
+                    blocks[i - first] = m_edits[i].block;
+                }
+            } else {
+                size_t buffer_idx = 0;
+                for (BlockChunkPositionCoord z = start.z; z <= end.z; ++z) {
+                    for (BlockChunkPositionCoord y = start.y; y <= end.y; ++y) {
+                        for (BlockChunkPositionCoord x = start.x; x <= end.x; ++x) {
+                            blocks[buffer_idx++] = chunk->blocks[block_index({ x, y, z })];
+                        }
+                    }
+                }
+
+                for (size_t i = first; i < last; ++i) {
+                    BlockChunkPosition position = block_chunk_position(m_edits[i].block_index);
+
+                    blocks[
+                        static_cast<size_t>(position.x - start.x)
+                            + static_cast<size_t>(position.y - start.y) * width
+                            + static_cast<size_t>(position.z - start.z) * width * height
+                    ] = m_edits[i].block;
+                }
+            }
+
+            gen_task_active = chunk->gen_task_active.load(std::memory_order_acquire);
+            if (!gen_task_active) {
+                bool should_cancel = chunk->on_bulk_block_change({
+                    chunk,
+                    blocks.data(),
+                    false,
+                    start,
+                    end
+                });
+
+                if (should_cancel) {
+                    all_applied = false;
+                    continue;
+                }
+            }
+
+            set_per_block_data(chunk->blocks, start, end, blocks.data());
+        }
+
+        if (!gen_task_active) {
+            chunk->on_bulk_block_changed({
+                chunk,
+                blocks.data(),
+                false,
+                start,
+                end
+            });
+        }
+    }
+
+    m_edits.clear();
+
+    return all_applied;
+}
@@ -4,77 +4,198 @@
 
 #include "voxel/block.hpp"
 #include "voxel/chunk/grid.h"
+#include "voxel/io/region_store.h"
+
+static inline hvox::ChunkGridPosition enclosing_chunk_position(const f32v3& position) {
+    hvox::ChunkGridPosition chunk_position;
+    chunk_position.id = 0;
+
+    chunk_position.x = static_cast<i64>(std::floor(position.x / static_cast<f32>(CHUNK_LENGTH)));
+    chunk_position.y = static_cast<i64>(std::floor(position.y / static_cast<f32>(CHUNK_LENGTH)));
+    chunk_position.z = static_cast<i64>(std::floor(position.z / static_cast<f32>(CHUNK_LENGTH)));
+
+    return chunk_position;
+}
+
+static inline i64 distance2(hvox::ChunkGridPosition a, hvox::ChunkGridPosition b) {
+    i64 dx = a.x - b.x;
+    i64 dy = a.y - b.y;
+    i64 dz = a.z - b.z;
+
+    return dx * dx + dy * dy + dz * dz;
+}
+
+hvox::ChunkTask::~ChunkTask() {
+    if (m_chunk_slots) m_chunk_slots->unpin(m_grace_period);
+}
 
 void hvox::ChunkTask::set_state(hmem::WeakHandle<Chunk> chunk, hmem::WeakHandle<ChunkGrid> chunk_grid) {
     m_chunk      = chunk;
     m_chunk_grid = chunk_grid;
+
+    m_chunk_position.id = 0;
+    if (auto handle = chunk.lock()) m_chunk_position = handle->position;
+
+    if (m_chunk_slots) m_chunk_slots->unpin(m_grace_period);
+    m_chunk_slots = nullptr;
+
+    if (auto grid = chunk_grid.lock()) {
+        m_chunk_slots  = &grid->chunk_slots();
+        m_grace_period = m_chunk_slots->pin();
+    }
+}
+
+bool hvox::ChunkTask::complete_if_empty_mesh(Chunk* chunk, bool quad_buffer /*= false*/) {
+    // The face of each neighbour that touches the chunk, in the
+    // order neighbours are held in.
+    static const BlockFace touching_faces[6] = {
+        BlockFace::RIGHT, BlockFace::LEFT,
+        BlockFace::BOTTOM, BlockFace::TOP,
+        BlockFace::BACK, BlockFace::FRONT
+    };
+
+    {
+        std::shared_lock block_lock(chunk->blocks_mutex);
+
+        if (!chunk->blocks.is_empty()) {
+            if (!chunk->blocks.is_full()) return false;
+
+            // Faces against absent neighbours are drawn, as they
+            // are for any other block.
+            for (ui32 i = 0; i < 6; ++i) {
+                Chunk* neighbour = linked_chunk(chunk->neighbours.all[i]);
+                if (neighbour == nullptr) return false;
+
+                std::shared_lock neighbour_lock(neighbour->blocks_mutex);
+
+                const ui8 face = static_cast<ui8>(touching_faces[i]);
+                if ((neighbour->blocks.solid_faces() & (1 << face)) == 0) return false;
+            }
+        }
+    }
+
+    // Only a chunk whose last mesh was not empty has anything
+    // in the renderer to be emptied.
+    const bool had_mesh = !chunk->mesh_empty.exchange(true, std::memory_order_acq_rel);
+    if (had_mesh) {
+        if (quad_buffer) {
+            chunk->instance.generate_quad_buffer();
+        } else {
+            chunk->instance.generate_buffer();
+        }
+    }
+
+    chunk->state.store(ChunkState::MESHED, std::memory_order_release);
+
+    chunk->mesh_task_active.store(false, std::memory_order_release);
+
+    if (had_mesh) chunk->on_mesh_change();
+
+    chunk->pending_task.store(ChunkTaskKind::NONE, std::memory_order_release);
+
+    return true;
+}
+
+bool hvox::ChunkTask::is_cancelled() {
+    auto chunk = m_chunk.lock();
+    if (chunk == nullptr) return true;
+
+    if (chunk->alive_state.load(std::memory_order_acquire) == ChunkAliveState::DEAD) return true;
+
+    return m_mesh_epoch != 0 && chunk->mesh_epoch.load(std::memory_order_acquire) != m_mesh_epoch;
 }
 
 hvox::ChunkGrid::ChunkGrid() :
-    // TODO(Matthew): both of these are rather inefficient, we remesh literally every block change, rather than
-    //                once per update loop, likewise with chunk loads.
-    // TODO(Matthew): as these are called in threadpool threads, we'd like them to
-    //                be able to use the appropriate producer tokens.
+    // NOTE(Matthew): none of these queue mesh tasks directly, rather
+    //                chunks are marked dirty and a single mesh task is
+    //                queued per dirty chunk in the next update. Block
+    //                changes are only seen once made, so cancelled
+    //                changes never cause a remesh.
+    //                  Loads are recorded here, and only in the next
+    //                  update is the chunk marked dirty, once it and
+    //                  its neighbours have all been generated.
     handle_chunk_load(Delegate<void(Sender)>{
         [&](Sender sender) {
             hmem::WeakHandle<Chunk> handle = sender.get_handle<Chunk>();
 
+            auto chunk = handle.lock();
+            // If chunk is nullptr, then there's no point
+            // handling the load as we will have an unload
+            // event for this chunk.
+            if (chunk == nullptr) return;
+
+            std::lock_guard lock(m_generated_chunks_mutex);
+
+            m_generated_chunks.emplace_back(HandleAndID{ handle, chunk->position.id });
+        }
+    }),
+    handle_block_change(Delegate<void(Sender, BlockChangeEvent)>{
+        [&](Sender sender, BlockChangeEvent event) {
+            hmem::WeakHandle<Chunk> handle = sender.get_handle<Chunk>();
+
             auto chunk = handle.lock();
             // If chunk is nullptr, then there's no point
             // handling the block change as we will have
             // an unload event for this chunk.
             if (chunk == nullptr) return;
 
-            auto task = m_build_mesh_task();
-            task->set_state(chunk, m_self);
-            m_thread_pool.threadsafe_add_task({task, true});
+            chunk->modified.store(true, std::memory_order_release);
+
+            mark_chunk_dirty(chunk->position, event.block_position, event.block_position);
         }
     }),
-    // TODO(Matthew): handle bulk block change too.
-    // TODO(Matthew): right now we remesh even if block change is cancelled.
-    //                perhaps we can count changes and if at least 1 change
-    //                on end of update loop then schedule remesh, only
-    //                incrementing if block change actually occurs
-    //                  i.e. stop queuing here.
-    handle_block_change(Delegate<bool(Sender, BlockChangeEvent)>{
-        [&](Sender sender, BlockChangeEvent) {
+    handle_bulk_block_change(Delegate<void(Sender, BulkBlockChangeEvent)>{
+        [&](Sender sender, BulkBlockChangeEvent event) {
             hmem::WeakHandle<Chunk> handle = sender.get_handle<Chunk>();
 
             auto chunk = handle.lock();
             // If chunk is nullptr, then there's no point
             // handling the block change as we will have
             // an unload event for this chunk.
-            if (chunk == nullptr) return true;
+            if (chunk == nullptr) return;
 
-            auto task = m_build_mesh_task();
-            task->set_state(chunk, m_self);
-            m_thread_pool.add_task({task, true});
+            chunk->modified.store(true, std::memory_order_release);
 
-            return false;
+            mark_chunk_dirty(chunk->position, event.start_position, event.end_position);
         }
-    })
+    }),
+    m_lod_distance(0),
+    m_stream_settings({ ChunkStreamShape::CYLINDER, 0, 0, 0, 0 }),
+    m_stream_stale(false)
 {
-    // Empty.
+    m_lod_view_position.id      = 0;
+    m_stream_focus_position.id  = 0;
 }
 
 void hvox::ChunkGrid::init( hmem::WeakHandle<ChunkGrid> self,
                                                    ui32 thread_count,
                                        ChunkTaskBuilder build_load_or_generate_task,
-                                       ChunkTaskBuilder build_mesh_task )
+                                       ChunkTaskBuilder build_mesh_task,
+                         hmem::Handle<ChunkRegionStore> region_store /*= nullptr*/,
+                                        ChunkMeshOutput mesh_output  /*= ChunkMeshOutput::CUBOID_INSTANCES*/,
+                                          ChunkDrawMode draw_mode    /*= ChunkDrawMode::PER_PAGE*/ )
 {
     m_self = self;
 
+    on_chunk_preload.set_sender(Sender(self));
+
+    m_region_store = region_store;
+
     m_build_load_or_generate_task   = build_load_or_generate_task;
     m_build_mesh_task               = build_mesh_task;
 
-    m_thread_pool.init(thread_count);
+    m_thread_pool.init(
+        thread_count,
+        thread::ThreadMainFunc<ChunkTaskContext>{thread::basic_thread_main<ChunkTaskContext>},
+        thread::ThreadPoolScheduling::PRIORITY
+    );
 
-    m_block_pager           = hmem::make_handle<ChunkBlockPager>();
-    m_instance_data_pager   = hmem::make_handle<ChunkInstanceDataPager>();
+    m_instance_data_pager = hmem::make_handle<ChunkInstanceDataPager>();
+    m_quad_data_pager     = hmem::make_handle<ChunkQuadDataPager>();
 
     // TODO(Matthew): smarter setting of page size - maybe should be dependent on draw distance.
     // m_renderer.init(20, 2);
-    m_renderer.init(5, 2);
+    m_renderer.init(5, 2, mesh_output, draw_mode);
 
 
     // TODO(Matthew): MOVE IT
@@ -98,6 +219,17 @@ void hvox::ChunkGrid::init( hmem::WeakHandle<ChunkGrid> self,
 
 void hvox::ChunkGrid::dispose() {
     m_thread_pool.dispose();
+
+    m_chunk_slots.dispose();
+
+    std::vector<ChunkGridPosition>().swap(m_stream_queue);
+
+    if (m_region_store) {
+        for (auto& [id, chunk] : m_chunks) {
+            if (chunk->modified.load(std::memory_order_acquire))
+                m_region_store->save(chunk);
+        }
+    }
 }
 
 void hvox::ChunkGrid::update(FrameTime time) {
@@ -105,11 +237,13 @@ void hvox::ChunkGrid::update(FrameTime time) {
         chunk.second->update(time);
     }
 
-    m_renderer.update(time);
-}
+    m_chunk_slots.reclaim();
+
+    process_generated_chunks();
+
+    process_dirty_chunks();
 
-void hvox::ChunkGrid::draw(FrameTime time) {
-    m_renderer.draw(time);
+    m_renderer.update(time);
 }
 
 void hvox::ChunkGrid::draw_grid() {
@@ -175,6 +309,197 @@ void hvox::ChunkGrid::draw_grid() {
     glDrawArrays(GL_LINES, 0, lines.size());
 }
 
+void hvox::ChunkGrid::set_lod_distance(ui32 lod_distance) {
+    m_lod_distance = lod_distance;
+
+    for (auto& [id, chunk] : m_chunks) {
+        set_render_state(chunk, render_state_at(chunk->position));
+    }
+}
+
+void hvox::ChunkGrid::update_render_states(const f32v3& view_position) {
+    ChunkGridPosition view_chunk_position = enclosing_chunk_position(view_position);
+
+    // Render states only change as the view moves between chunks.
+    if (view_chunk_position.id == m_lod_view_position.id) return;
+
+    m_lod_view_position = view_chunk_position;
+
+    // Without streaming, tasks are prioritised by distance from
+    // the view position, so those queued are reprioritised as it
+    // moves.
+    if (m_stream_settings.view_distance == 0) {
+        m_thread_pool.reprioritise([&](thread::IThreadTask<ChunkTaskContext>* task) {
+            return task_priority(static_cast<ChunkTask*>(task)->chunk_position());
+        });
+    }
+
+    if (m_lod_distance == 0) return;
+
+    for (auto& [id, chunk] : m_chunks) {
+        set_render_state(chunk, render_state_at(chunk->position));
+    }
+}
+
+hvox::RenderState hvox::ChunkGrid::render_state_at(ChunkGridPosition chunk_position) const {
+    if (m_lod_distance == 0) return RenderState::FULL;
+
+    i64 distance = std::max({
+        std::abs(chunk_position.x - m_lod_view_position.x),
+        std::abs(chunk_position.y - m_lod_view_position.y),
+        std::abs(chunk_position.z - m_lod_view_position.z)
+    });
+
+    // Each doubling of distance beyond the LOD distance drops
+    // one level of detail.
+    ui32 steps = 0;
+    for (i64 threshold = m_lod_distance; distance >= threshold; threshold *= 2) {
+        ++steps;
+    }
+
+    const ui32 full = static_cast<ui32>(RenderState::FULL);
+    const ui32 min  = static_cast<ui32>(RenderState::LOD_0);
+
+    return static_cast<RenderState>(full - std::min(steps, full - min));
+}
+
+void hvox::ChunkGrid::set_render_state(hmem::Handle<Chunk> chunk, RenderState render_state) {
+    if (chunk->render_state.exchange(render_state, std::memory_order_acq_rel) == render_state) return;
+
+    chunk->on_render_state_change(render_state);
+
+    // The chunk's current mesh is drawn until its new one
+    // is uploaded in its place.
+    mark_chunk_dirty(chunk->position);
+}
+
+void hvox::ChunkGrid::set_streaming(const ChunkStreamSettings& settings) {
+    m_stream_settings = settings;
+
+    // The streamed volume is rebuilt on the next update,
+    // whether or not the focus has moved.
+    m_stream_stale = true;
+
+    if (m_stream_settings.view_distance == 0) {
+        std::vector<ChunkGridPosition>().swap(m_stream_queue);
+    }
+}
+
+void hvox::ChunkGrid::update_streaming(const f32v3& focus) {
+    if (m_stream_settings.view_distance == 0) return;
+
+    ChunkGridPosition focus_chunk_position = enclosing_chunk_position(focus);
+
+    // The streamed volume only changes as the focus moves
+    // between chunks.
+    if (m_stream_stale || focus_chunk_position.id != m_stream_focus_position.id) {
+        m_stream_focus_position = focus_chunk_position;
+        m_stream_stale          = false;
+
+        // Work queued for chunks now near the focus jumps ahead
+        // of that queued for chunks now far from it.
+        m_thread_pool.reprioritise([&](thread::IThreadTask<ChunkTaskContext>* task) {
+            return task_priority(static_cast<ChunkTask*>(task)->chunk_position());
+        });
+
+        restream();
+    }
+
+    size_t count = std::min(
+        static_cast<size_t>(m_stream_settings.load_budget),
+        m_stream_queue.size()
+    );
+    size_t first = m_stream_queue.size() - count;
+
+    // All chunks in the batch are preloaded before any are
+    // loaded, so that those neighbouring each other know of
+    // each other before generating.
+    for (size_t i = first; i < m_stream_queue.size(); ++i) {
+        preload_chunk_at(m_stream_queue[i]);
+    }
+    for (size_t i = first; i < m_stream_queue.size(); ++i) {
+        load_chunk_at(m_stream_queue[i]);
+    }
+
+    m_stream_queue.resize(first);
+}
+
+bool hvox::ChunkGrid::in_stream_volume(ChunkGridPosition chunk_position) const {
+    const i64 radius = static_cast<i64>(m_stream_settings.view_distance);
+
+    if (m_stream_settings.shape == ChunkStreamShape::CYLINDER) {
+        if (chunk_position.y < m_stream_settings.min_y || chunk_position.y > m_stream_settings.max_y)
+            return false;
+
+        i64 dx = chunk_position.x - m_stream_focus_position.x;
+        i64 dz = chunk_position.z - m_stream_focus_position.z;
+
+        return dx * dx + dz * dz <= radius * radius;
+    }
+
+    return distance2(chunk_position, m_stream_focus_position) <= radius * radius;
+}
+
+ui32 hvox::ChunkGrid::task_priority(ChunkGridPosition chunk_position) const {
+    // Grids not streaming have chunks loaded by hand, and so their
+    // streaming focus is never set, the view position is used instead.
+    const ChunkGridPosition focus = m_stream_settings.view_distance == 0
+                                        ? m_lod_view_position
+                                        : m_stream_focus_position;
+
+    i64 distance = distance2(chunk_position, focus);
+
+    return static_cast<ui32>(std::min(distance, static_cast<i64>(std::numeric_limits<ui32>::max())));
+}
+
+void hvox::ChunkGrid::restream() {
+    std::vector<ChunkGridPosition> unloads;
+    for (auto& [id, chunk] : m_chunks) {
+        if (!in_stream_volume(chunk->position)) unloads.emplace_back(chunk->position);
+    }
+
+    for (auto chunk_position : unloads) {
+        unload_chunk_at(chunk_position);
+    }
+
+    m_stream_queue.clear();
+
+    const i64 radius = static_cast<i64>(m_stream_settings.view_distance);
+
+    i64 min_y = m_stream_focus_position.y - radius;
+    i64 max_y = m_stream_focus_position.y + radius;
+    if (m_stream_settings.shape == ChunkStreamShape::CYLINDER) {
+        min_y = m_stream_settings.min_y;
+        max_y = m_stream_settings.max_y;
+    }
+
+    for (i64 x = m_stream_focus_position.x - radius; x <= m_stream_focus_position.x + radius; ++x) {
+        for (i64 z = m_stream_focus_position.z - radius; z <= m_stream_focus_position.z + radius; ++z) {
+            for (i64 y = min_y; y <= max_y; ++y) {
+                ChunkGridPosition chunk_position;
+                chunk_position.id = 0;
+
+                chunk_position.x = x;
+                chunk_position.y = y;
+                chunk_position.z = z;
+
+                if (!in_stream_volume(chunk_position)) continue;
+
+                if (m_chunks.contains(chunk_position.id)) continue;
+
+                m_stream_queue.emplace_back(chunk_position);
+            }
+        }
+    }
+
+    // Furthest first, as chunks are taken from the back.
+    std::sort(m_stream_queue.begin(), m_stream_queue.end(),
+        [&](ChunkGridPosition lhs, ChunkGridPosition rhs) {
+            return distance2(lhs, m_stream_focus_position) > distance2(rhs, m_stream_focus_position);
+        }
+    );
+}
+
 bool hvox::ChunkGrid::load_from_scratch_chunks(ChunkGridPosition* chunk_positions, ui32 chunk_count) {
     bool any_chunk_failed = false;
 
@@ -195,17 +520,35 @@ bool hvox::ChunkGrid::preload_chunk_at(ChunkGridPosition chunk_position) {
 
     hmem::Handle<Chunk> chunk = hmem::allocate_handle<Chunk>(m_chunk_allocator);
     chunk->position = chunk_position;
-    chunk->init(chunk, m_block_pager, m_instance_data_pager);
+    chunk->init(chunk, m_instance_data_pager, m_quad_data_pager, m_renderer.staging_buffer());
+
+    chunk->render_state.store(render_state_at(chunk_position), std::memory_order_release);
 
-    chunk->on_load          += &handle_chunk_load;
-    chunk->on_block_change  += &handle_block_change;
+    chunk->on_load                  += &handle_chunk_load;
+    chunk->on_block_changed         += &handle_block_change;
+    chunk->on_bulk_block_changed    += &handle_bulk_block_change;
+
+    chunk->slot = m_chunk_slots.acquire(chunk);
 
     establish_chunk_neighbours(chunk);
 
+    // The new chunk is yet to be generated, so each of its
+    // neighbours waits on it, and it on those of them not
+    // yet generated.
+    for_each_neighbour(chunk_position, Delegate<void(hmem::Handle<Chunk>)>{
+        [&](hmem::Handle<Chunk> neighbour) {
+            neighbour->ungenerated_neighbour_count += 1;
+
+            if (!neighbour->generation_seen) chunk->ungenerated_neighbour_count += 1;
+        }
+    });
+
     m_chunks[chunk_position.id] = chunk;
 
     m_renderer.add_chunk(chunk);
 
+    on_chunk_preload(chunk);
+
     return true;
 }
 
@@ -251,6 +594,7 @@ bool hvox::ChunkGrid::load_chunk_at(ChunkGridPosition chunk_position) {
 
     auto task = m_build_load_or_generate_task();
     task->set_state(chunk, m_self);
+    task->priority = task_priority(chunk_position);
     m_thread_pool.add_task({task, true});
 
     return true;
@@ -266,16 +610,32 @@ bool hvox::ChunkGrid::unload_chunk_at(ChunkGridPosition chunk_position, hmem::We
     auto it = m_chunks.find(chunk_position.id);
     if (it == m_chunks.end()) return false;
 
+    (*it).second->alive_state.store(ChunkAliveState::DEAD, std::memory_order_release);
+
+    // Links to the chunk are invalid from here, though it lives on
+    // until tasks that may have followed them have finished.
+    m_chunk_slots.release((*it).second->slot);
+
+    // Neighbours no longer wait on a chunk that will now
+    // never be generated.
+    if (!(*it).second->generation_seen) release_neighbours(chunk_position);
+
     (*it).second->on_unload();
 
     if (handle) {
         *handle = (*it).second;
     }
 
-    // TODO(Matthew): wherever unloaded, we need to make sure we get IO right,
-    //                as chunk will "float" and something could act as if that
-    //                floating data is true even as the chunk is reloaded from
-    //                disk with a different truth.
+    // The region store holds onto the saved snapshot until it is
+    // written, and serves any reload of this chunk from it, so a
+    // chunk reloaded before its save completes never sees stale
+    // data on disk.
+    //   Blocks changed on the now-floating chunk after this
+    //   point are however lost. Chunks unchanged since they
+    //   were last loaded or saved are already on disk as they
+    //   are, so are not saved again.
+    if (m_region_store && (*it).second->modified.load(std::memory_order_acquire))
+        m_region_store->save((*it).second);
 
     m_chunks.erase(it);
 
@@ -290,74 +650,194 @@ hmem::Handle<hvox::Chunk> hvox::ChunkGrid::chunk(ChunkID id) {
     return it->second;
 }
 
-void hvox::ChunkGrid::establish_chunk_neighbours(hmem::Handle<Chunk> chunk) {
+void hvox::ChunkGrid::mark_chunk_dirty(ChunkGridPosition chunk_position) {
+    std::lock_guard lock(m_dirty_chunks_mutex);
+
+    m_dirty_chunks.insert(chunk_position.id);
+}
+
+void hvox::ChunkGrid::mark_chunk_dirty( ChunkGridPosition chunk_position,
+                                       BlockChunkPosition start_block_position,
+                                       BlockChunkPosition end_block_position )
+{
+    std::lock_guard lock(m_dirty_chunks_mutex);
+
+    m_dirty_chunks.insert(chunk_position.id);
+
+    // Changes on a face of the chunk can change what is
+    // visible of the neighbour sharing that face.
     ChunkGridPosition neighbour_position;
 
-    // Update neighbours with info of new chunk.
     // LEFT
-    neighbour_position = chunk->position;
-    neighbour_position.x -= 1;
-    auto it = m_chunks.find(neighbour_position.id);
-    if (it != m_chunks.end()) {
-        chunk->neighbours.one.left = (*it).second;
-        (*it).second->neighbours.one.right = chunk;
-    } else {
-        chunk->neighbours.one.left = hmem::WeakHandle<Chunk>();
+    if (start_block_position.x == 0) {
+        neighbour_position = chunk_position;
+        neighbour_position.x -= 1;
+        m_dirty_chunks.insert(neighbour_position.id);
     }
 
     // RIGHT
-    neighbour_position = chunk->position;
-    neighbour_position.x += 1;
-    it = m_chunks.find(neighbour_position.id);
-    if (it != m_chunks.end()) {
-        chunk->neighbours.one.right = (*it).second;
-        (*it).second->neighbours.one.left = chunk;
-    } else {
-        chunk->neighbours.one.right = hmem::WeakHandle<Chunk>();
+    if (end_block_position.x == CHUNK_LENGTH - 1) {
+        neighbour_position = chunk_position;
+        neighbour_position.x += 1;
+        m_dirty_chunks.insert(neighbour_position.id);
     }
 
-    // TOP
-    neighbour_position = chunk->position;
-    neighbour_position.y += 1;
-    it = m_chunks.find(neighbour_position.id);
-    if (it != m_chunks.end()) {
-        chunk->neighbours.one.top = (*it).second;
-        (*it).second->neighbours.one.bottom = chunk;
-    } else {
-        chunk->neighbours.one.top = hmem::WeakHandle<Chunk>();
+    // BOTTOM
+    if (start_block_position.y == 0) {
+        neighbour_position = chunk_position;
+        neighbour_position.y -= 1;
+        m_dirty_chunks.insert(neighbour_position.id);
     }
 
-    // BOTTOM
-    neighbour_position = chunk->position;
-    neighbour_position.y -= 1;
-    it = m_chunks.find(neighbour_position.id);
-    if (it != m_chunks.end()) {
-        chunk->neighbours.one.bottom = (*it).second;
-        (*it).second->neighbours.one.top = chunk;
-    } else {
-        chunk->neighbours.one.bottom = hmem::WeakHandle<Chunk>();
+    // TOP
+    if (end_block_position.y == CHUNK_LENGTH - 1) {
+        neighbour_position = chunk_position;
+        neighbour_position.y += 1;
+        m_dirty_chunks.insert(neighbour_position.id);
     }
 
     // FRONT
-    neighbour_position = chunk->position;
-    neighbour_position.z -= 1;
-    it = m_chunks.find(neighbour_position.id);
-    if (it != m_chunks.end()) {
-        chunk->neighbours.one.front = (*it).second;
-        (*it).second->neighbours.one.back = chunk;
-    } else {
-        chunk->neighbours.one.front = hmem::WeakHandle<Chunk>();
+    if (start_block_position.z == 0) {
+        neighbour_position = chunk_position;
+        neighbour_position.z -= 1;
+        m_dirty_chunks.insert(neighbour_position.id);
     }
 
     // BACK
-    neighbour_position = chunk->position;
-    neighbour_position.z += 1;
-    it = m_chunks.find(neighbour_position.id);
-    if (it != m_chunks.end()) {
-        chunk->neighbours.one.back = (*it).second;
-        (*it).second->neighbours.one.front = chunk;
-    } else {
-        chunk->neighbours.one.back = hmem::WeakHandle<Chunk>();
+    if (end_block_position.z == CHUNK_LENGTH - 1) {
+        neighbour_position = chunk_position;
+        neighbour_position.z += 1;
+        m_dirty_chunks.insert(neighbour_position.id);
+    }
+}
+
+void hvox::ChunkGrid::for_each_neighbour(ChunkGridPosition chunk_position, Delegate<void(hmem::Handle<Chunk>)> func) {
+    static const i32v3 offsets[6] = {
+        { -1,  0,  0 }, { 1, 0, 0 },
+        {  0, -1,  0 }, { 0, 1, 0 },
+        {  0,  0, -1 }, { 0, 0, 1 }
+    };
+
+    for (const auto& offset : offsets) {
+        auto it = m_chunks.find(chunk_position, offset);
+        if (it == m_chunks.end()) continue;
+
+        func((*it).second);
+    }
+}
+
+void hvox::ChunkGrid::release_neighbours(ChunkGridPosition chunk_position) {
+    for_each_neighbour(chunk_position, Delegate<void(hmem::Handle<Chunk>)>{
+        [&](hmem::Handle<Chunk> neighbour) {
+            neighbour->ungenerated_neighbour_count -= 1;
+
+            if (neighbour->ungenerated_neighbour_count == 0 && neighbour->generation_seen)
+                mark_chunk_dirty(neighbour->position);
+        }
+    });
+}
+
+void hvox::ChunkGrid::process_generated_chunks() {
+    std::vector<HandleAndID> generated_chunks;
+    {
+        std::lock_guard lock(m_generated_chunks_mutex);
+
+        generated_chunks.swap(m_generated_chunks);
+    }
+
+    for (auto& handle_and_id : generated_chunks) {
+        auto it = m_chunks.find(handle_and_id.id);
+        // Chunk has since been unloaded.
+        if (it == m_chunks.end()) continue;
+
+        hmem::Handle<Chunk> chunk = (*it).second;
+
+        // Chunk has since been unloaded, and another
+        // preloaded at the same position, whose load
+        // is yet to be seen.
+        if (handle_and_id.handle.lock() != chunk) continue;
+
+        if (chunk->generation_seen) continue;
+        chunk->generation_seen = true;
+
+        release_neighbours(chunk->position);
+
+        if (chunk->ungenerated_neighbour_count == 0) mark_chunk_dirty(chunk->position);
+    }
+}
+
+void hvox::ChunkGrid::process_dirty_chunks() {
+    std::unordered_set<ChunkID> dirty_chunks;
+    {
+        std::lock_guard lock(m_dirty_chunks_mutex);
+
+        dirty_chunks.swap(m_dirty_chunks);
+    }
+
+    if (dirty_chunks.empty()) return;
+
+    std::vector<thread::HeldTask<ChunkTaskContext>> tasks;
+    tasks.reserve(dirty_chunks.size());
+
+    for (auto id : dirty_chunks) {
+        auto it = m_chunks.find(id);
+        // Chunk has since been unloaded, or was a
+        // neighbour that was never loaded.
+        if (it == m_chunks.end()) continue;
+
+        hmem::Handle<Chunk> chunk = (*it).second;
+
+        // Chunks not yet generated will be meshed
+        // once they are, as they then get marked
+        // dirty on load.
+        auto [ _, chunk_generated ] = query_chunk_state(chunk, ChunkState::GENERATED);
+        if (!chunk_generated) continue;
+
+        // Chunks with neighbours still to be generated will
+        // be meshed once the last of them is.
+        if (chunk->ungenerated_neighbour_count > 0) continue;
+
+        // Epoch zero is reserved for tasks that are never
+        // superseded.
+        ui32 mesh_epoch = chunk->mesh_epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+        if (mesh_epoch == 0) mesh_epoch = chunk->mesh_epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+        auto task = m_build_mesh_task();
+        task->set_state(chunk, m_self);
+        task->set_mesh_epoch(mesh_epoch);
+        task->priority = task_priority(chunk->position);
+        tasks.push_back({task, true});
+    }
+
+    if (!tasks.empty()) m_thread_pool.add_tasks(tasks.data(), tasks.size());
+}
+
+void hvox::ChunkGrid::establish_chunk_neighbours(hmem::Handle<Chunk> chunk) {
+    static const ChunkSlotHandle NULL_SLOT = { 0, 0 };
+
+    // Offsets of the neighbours, in the order they are linked in,
+    // along with the face of each that touches the new chunk.
+    static const struct {
+        i32v3 offset;
+        ui32  opposite_face;
+    } faces[6] = {
+        { { -1,  0,  0 }, 1 }, // LEFT
+        { {  1,  0,  0 }, 0 }, // RIGHT
+        { {  0,  1,  0 }, 3 }, // TOP
+        { {  0, -1,  0 }, 2 }, // BOTTOM
+        { {  0,  0, -1 }, 5 }, // FRONT
+        { {  0,  0,  1 }, 4 }  // BACK
+    };
+
+    // Update neighbours with info of new chunk.
+    for (ui32 face = 0; face < 6; ++face) {
+        auto it = m_chunks.find(chunk->position, faces[face].offset);
+        if (it != m_chunks.end()) {
+            chunk->neighbours.all[face].store((*it).second->slot, std::memory_order_release);
+            (*it).second->neighbours.all[faces[face].opposite_face].store(chunk->slot, std::memory_order_release);
+        } else {
+            chunk->neighbours.all[face].store(NULL_SLOT, std::memory_order_release);
+        }
     }
 }
 
@@ -402,8 +882,8 @@ hvox::QueriedChunkState hvox::ChunkGrid::query_all_neighbour_states(hmem::Handle
     if (chunk == nullptr) return {false, false};
 
     bool all_neighbours_satisfy_constraint = true;
-    for (ui32 i = 0; i < 8; ++i) {
-        auto neighbour = chunk->neighbours.all[i].lock();
+    for (ui32 i = 0; i < 6; ++i) {
+        Chunk* neighbour = m_chunk_slots.get(chunk->neighbours.all[i].load(std::memory_order_acquire));
         if (neighbour == nullptr) continue;
 
         ChunkState actual_state = neighbour->state.load(std::memory_order_acquire);
@@ -455,8 +935,8 @@ hvox::QueriedChunkState hvox::ChunkGrid::query_all_neighbour_exact_states(hmem::
     if (chunk == nullptr) return {false, false};
 
     bool all_neighbours_satisfy_constraint = true;
-    for (ui32 i = 0; i < 8; ++i) {
-        auto neighbour = chunk->neighbours.all[i].lock();
+    for (ui32 i = 0; i < 6; ++i) {
+        Chunk* neighbour = m_chunk_slots.get(chunk->neighbours.all[i].load(std::memory_order_acquire));
         if (neighbour == nullptr) continue;
 
         ChunkState actual_state = neighbour->state.load(std::memory_order_acquire);
@@ -0,0 +1,134 @@
+#include "stdafx.h"
+
+#include "voxel/chunk.h"
+
+#include "voxel/chunk/index.h"
+
+// The table is grown whenever it would be more than
+// half full, keeping probe sequences short.
+static const size_t MIN_SLOT_COUNT = 64;
+
+hvox::ChunkIndex::ChunkIndex() :
+    m_slots(MIN_SLOT_COUNT, Slot{ 0, NO_ENTRY })
+{ /* Empty. */ }
+
+hvox::ChunkIndex::iterator hvox::ChunkIndex::find(ChunkID id) {
+    size_t slot_idx = find_slot(id);
+    if (slot_idx == NO_SLOT) return m_entries.end();
+
+    return m_entries.begin() + m_slots[slot_idx].entry_idx;
+}
+
+hvox::ChunkIndex::iterator hvox::ChunkIndex::find(ChunkGridPosition position, i32v3 offset) {
+    position.x += offset.x;
+    position.y += offset.y;
+    position.z += offset.z;
+
+    return find(position.id);
+}
+
+hmem::Handle<hvox::Chunk>& hvox::ChunkIndex::operator[](ChunkID id) {
+    size_t slot_idx = find_slot(id);
+    if (slot_idx != NO_SLOT) return m_entries[m_slots[slot_idx].entry_idx].second;
+
+    if (2 * (m_entries.size() + 1) > m_slots.size()) rehash(2 * m_slots.size());
+
+    slot_idx = home_slot(id);
+    while (m_slots[slot_idx].entry_idx != NO_ENTRY) {
+        slot_idx = (slot_idx + 1) & (m_slots.size() - 1);
+    }
+
+    m_slots[slot_idx] = Slot{ id, static_cast<ui32>(m_entries.size()) };
+    m_entries.emplace_back(id, nullptr);
+
+    return m_entries.back().second;
+}
+
+void hvox::ChunkIndex::erase(iterator it) {
+    erase(it->first);
+}
+
+bool hvox::ChunkIndex::erase(ChunkID id) {
+    size_t slot_idx = find_slot(id);
+    if (slot_idx == NO_SLOT) return false;
+
+    const ui32 entry_idx = m_slots[slot_idx].entry_idx;
+    const ui32 last_idx  = static_cast<ui32>(m_entries.size() - 1);
+
+    // Move the last entry into the place of the erased one,
+    // pointing its slot at its new place.
+    if (entry_idx != last_idx) {
+        m_slots[find_slot(m_entries[last_idx].first)].entry_idx = entry_idx;
+
+        m_entries[entry_idx] = std::move(m_entries[last_idx]);
+    }
+    m_entries.pop_back();
+
+    /*
+     * Shift back any slots after the erased one that would
+     * otherwise no longer be reachable from their home slot,
+     * stopping at the first empty slot.
+     */
+    const size_t mask = m_slots.size() - 1;
+
+    size_t hole = slot_idx;
+    size_t next = (hole + 1) & mask;
+    while (m_slots[next].entry_idx != NO_ENTRY) {
+        size_t home = home_slot(m_slots[next].id);
+
+        // The slot may fill the hole if its home is not within
+        // the wrapping range (hole, next].
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            m_slots[hole] = m_slots[next];
+            hole          = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    m_slots[hole] = Slot{ 0, NO_ENTRY };
+
+    return true;
+}
+
+void hvox::ChunkIndex::clear() {
+    Entries().swap(m_entries);
+    std::vector<Slot>(MIN_SLOT_COUNT, Slot{ 0, NO_ENTRY }).swap(m_slots);
+}
+
+ui64 hvox::ChunkIndex::mix(ChunkID id) {
+    // Finaliser of SplitMix64, so that the bits of x, y
+    // and z packed into the ID all reach the low bits.
+    id ^= id >> 30;
+    id *= 0xbf58476d1ce4e5b9ull;
+    id ^= id >> 27;
+    id *= 0x94d049bb133111ebull;
+    id ^= id >> 31;
+
+    return id;
+}
+
+size_t hvox::ChunkIndex::find_slot(ChunkID id) const {
+    const size_t mask = m_slots.size() - 1;
+
+    for (size_t slot_idx = home_slot(id); m_slots[slot_idx].entry_idx != NO_ENTRY; slot_idx = (slot_idx + 1) & mask) {
+        if (m_slots[slot_idx].id == id) return slot_idx;
+    }
+
+    return NO_SLOT;
+}
+
+void hvox::ChunkIndex::rehash(size_t slot_count) {
+    std::vector<Slot>(slot_count, Slot{ 0, NO_ENTRY }).swap(m_slots);
+
+    const size_t mask = slot_count - 1;
+
+    for (ui32 entry_idx = 0; entry_idx < m_entries.size(); ++entry_idx) {
+        size_t slot_idx = home_slot(m_entries[entry_idx].first);
+        while (m_slots[slot_idx].entry_idx != NO_ENTRY) {
+            slot_idx = (slot_idx + 1) & mask;
+        }
+
+        m_slots[slot_idx] = Slot{ m_entries[entry_idx].first, entry_idx };
+    }
+}
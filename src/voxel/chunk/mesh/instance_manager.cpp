@@ -2,19 +2,27 @@
 #include "voxel/chunk/mesh/instance_manager.h"
 
 hvox::ChunkInstanceManager::ChunkInstanceManager() :
-    m_instance({nullptr, 0})
+    m_instance({nullptr, 0, nullptr, 0}),
+    m_data_staged(false),
+    m_quads_staged(false)
 { /* Empty. */ }
 
-void hvox::ChunkInstanceManager::init(hmem::Handle<ChunkInstanceDataPager> data_pager) {
-    m_data_pager = data_pager;
+void hvox::ChunkInstanceManager::init(
+    hmem::Handle<ChunkInstanceDataPager> data_pager,
+        hmem::Handle<ChunkQuadDataPager> quad_pager,
+        hmem::Handle<ChunkStagingBuffer> staging_buffer /*= nullptr*/
+) {
+    m_data_pager     = data_pager;
+    m_quad_pager     = quad_pager;
+    m_staging_buffer = staging_buffer;
 }
 
 void hvox::ChunkInstanceManager::dispose() {
-    if (m_instance.data) m_data_pager->free_page(m_instance.data);
+    release_buffers();
 
-    m_instance.data     = nullptr;
-    m_instance.count    = 0;
-    m_data_pager = nullptr;
+    m_data_pager     = nullptr;
+    m_quad_pager     = nullptr;
+    m_staging_buffer = nullptr;
 }
 
 hvox::ChunkInstance& hvox::ChunkInstanceManager::get(std::unique_lock<std::shared_mutex>& lock) {
@@ -31,13 +39,60 @@ void hvox::ChunkInstanceManager::generate_buffer() {
     std::unique_lock lock(m_mutex);
 
     m_instance.count = 0;
+    if (m_instance.data) return;
+
+    if (m_staging_buffer) {
+        m_instance.data = static_cast<ChunkInstanceData*>(
+            m_staging_buffer->acquire_block(CHUNK_VOLUME / 2 * sizeof(ChunkInstanceData))
+        );
+        m_data_staged = m_instance.data != nullptr;
+    }
+
     if (!m_instance.data) m_instance.data = m_data_pager->get_page();
 }
 
+void hvox::ChunkInstanceManager::generate_quad_buffer() {
+    std::unique_lock lock(m_mutex);
+
+    m_instance.quad_count = 0;
+    if (m_instance.quads) return;
+
+    if (m_staging_buffer) {
+        m_instance.quads = static_cast<ChunkQuadData*>(
+            m_staging_buffer->acquire_block(CHUNK_VOLUME * 3 * sizeof(ChunkQuadData))
+        );
+        m_quads_staged = m_instance.quads != nullptr;
+    }
+
+    if (!m_instance.quads) m_instance.quads = m_quad_pager->get_page();
+}
+
 void hvox::ChunkInstanceManager::free_buffer() {
     std::unique_lock lock(m_mutex);
 
+    release_buffers();
+}
+
+void hvox::ChunkInstanceManager::release_buffers() {
+    if (m_instance.data) {
+        if (m_data_staged) {
+            m_staging_buffer->release_block(m_instance.data);
+        } else {
+            m_data_pager->free_page(m_instance.data);
+        }
+    }
+    m_instance.data  = nullptr;
     m_instance.count = 0;
-    if (m_instance.data) m_data_pager->free_page(m_instance.data);
-    m_instance.data = nullptr;
+    m_data_staged    = false;
+
+    if (m_instance.quads) {
+        if (m_quads_staged) {
+            m_staging_buffer->release_block(m_instance.quads);
+        } else {
+            m_quad_pager->free_page(m_instance.quads);
+        }
+    }
+    m_instance.quads      = nullptr;
+    m_instance.quad_count = 0;
+    m_quads_staged        = false;
 }
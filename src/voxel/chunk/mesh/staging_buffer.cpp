@@ -0,0 +1,118 @@
+#include "stdafx.h"
+
+#include "voxel/chunk/mesh/staging_buffer.h"
+
+hvox::ChunkStagingBuffer::ChunkStagingBuffer() :
+    m_buffer(0),
+    m_mapped(nullptr),
+    m_block_size(0),
+    m_block_count(0)
+{ /* Empty. */ }
+
+void hvox::ChunkStagingBuffer::init(size_t block_size, ui32 block_count) {
+    m_block_size  = block_size;
+    m_block_count = block_count;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, m_block_size * m_block_count, nullptr, flags);
+
+    m_mapped = static_cast<ui8*>(
+        glMapNamedBufferRange(m_buffer, 0, m_block_size * m_block_count, flags)
+    );
+
+    std::lock_guard lock(m_blocks_mutex);
+
+    m_free_blocks.reserve(m_block_count);
+    for (ui32 block_idx = m_block_count; block_idx > 0; --block_idx) {
+        m_free_blocks.emplace_back(block_idx - 1);
+    }
+}
+
+void hvox::ChunkStagingBuffer::dispose() {
+    while (!m_fenced_blocks.empty()) {
+        glDeleteSync(m_fenced_blocks.front().fence);
+        m_fenced_blocks.pop();
+    }
+
+    {
+        std::lock_guard lock(m_blocks_mutex);
+
+        std::vector<ui32>().swap(m_free_blocks);
+        std::vector<ui32>().swap(m_released_blocks);
+
+        m_block_count = 0;
+    }
+
+    if (m_buffer != 0) {
+        glUnmapNamedBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+    }
+
+    m_buffer = 0;
+    m_mapped = nullptr;
+}
+
+void* hvox::ChunkStagingBuffer::acquire_block(size_t size) {
+    if (size > m_block_size) return nullptr;
+
+    std::lock_guard lock(m_blocks_mutex);
+
+    if (m_free_blocks.empty()) return nullptr;
+
+    ui32 block_idx = m_free_blocks.back();
+    m_free_blocks.pop_back();
+
+    return m_mapped + block_idx * m_block_size;
+}
+
+void hvox::ChunkStagingBuffer::release_block(const void* block) {
+    std::lock_guard lock(m_blocks_mutex);
+
+    // Blocks outlived the buffer.
+    if (m_block_count == 0) return;
+
+    m_released_blocks.emplace_back(static_cast<ui32>(offset_of(block) / m_block_size));
+}
+
+void hvox::ChunkStagingBuffer::fence() {
+    std::vector<ui32> released;
+    {
+        std::lock_guard lock(m_blocks_mutex);
+
+        released.swap(m_released_blocks);
+    }
+
+    if (!released.empty()) {
+        m_fenced_blocks.push(FencedBlocks{
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+            std::move(released)
+        });
+    }
+
+    // Fences signal in order, so stop at the first that
+    // has yet to.
+    while (!m_fenced_blocks.empty()) {
+        FencedBlocks& fenced = m_fenced_blocks.front();
+
+        GLenum result = glClientWaitSync(fenced.fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) break;
+
+        glDeleteSync(fenced.fence);
+
+        {
+            std::lock_guard lock(m_blocks_mutex);
+
+            m_free_blocks.insert(m_free_blocks.end(), fenced.blocks.begin(), fenced.blocks.end());
+        }
+
+        m_fenced_blocks.pop();
+    }
+}
+
+bool hvox::ChunkStagingBuffer::owns(const void* data) const {
+    const ui8* ptr = static_cast<const ui8*>(data);
+
+    return m_mapped != nullptr && ptr >= m_mapped && ptr < m_mapped + m_block_size * m_block_count;
+}
@@ -0,0 +1,168 @@
+#include "stdafx.h"
+
+#include "voxel/chunk/occupancy_pyramid.h"
+
+hvox::ChunkOccupancyPyramid::ChunkOccupancyPyramid() :
+    m_bits(nullptr),
+    m_uniform_solid(false)
+{ /* Empty. */ }
+
+hvox::ChunkOccupancyPyramid::~ChunkOccupancyPyramid() {
+    delete[] m_bits;
+}
+
+void hvox::ChunkOccupancyPyramid::fill(bool solid) {
+    delete[] m_bits;
+    m_bits = nullptr;
+
+    m_uniform_solid = solid;
+}
+
+void hvox::ChunkOccupancyPyramid::set(BlockIndex index, bool solid) {
+    if (is_uniform() && m_uniform_solid == solid) return;
+
+    set_unpropagated(index, solid);
+
+    ui32 x = index % CHUNK_LENGTH;
+    ui32 y = (index / CHUNK_LENGTH) % CHUNK_LENGTH;
+    ui32 z = index / (CHUNK_AREA);
+
+    /*
+     * Setting a block solid sets each cell above it until one
+     * is found already set, while clearing one clears each cell
+     * above it until one is found that is still partly solid.
+     */
+    for (ui32 level = 1; level < LEVEL_COUNT; ++level) {
+        x >>= 1; y >>= 1; z >>= 1;
+
+        if (solid) {
+            if (get_bit(level, x, y, z)) return;
+        } else {
+            if (any_child_solid(level, x, y, z)) return;
+        }
+
+        set_bit(level, x, y, z, solid);
+    }
+}
+
+void hvox::ChunkOccupancyPyramid::set_unpropagated(BlockIndex index, bool solid) {
+    if (is_uniform()) {
+        if (m_uniform_solid == solid) return;
+
+        expand();
+    }
+
+    const size_t word = index / 64;
+    const ui64   bit  = ui64{1} << (index % 64);
+
+    if (solid) {
+        m_bits[word] |= bit;
+    } else {
+        m_bits[word] &= ~bit;
+    }
+}
+
+void hvox::ChunkOccupancyPyramid::rebuild() {
+    if (is_uniform()) return;
+
+    for (ui32 level = 1; level < LEVEL_COUNT; ++level) {
+        const ui32 length = side(level);
+
+        for (ui32 z = 0; z < length; ++z) {
+            for (ui32 y = 0; y < length; ++y) {
+                for (ui32 x = 0; x < length; ++x) {
+                    set_bit(level, x, y, z, any_child_solid(level, x, y, z));
+                }
+            }
+        }
+    }
+}
+
+bool hvox::ChunkOccupancyPyramid::is_solid(ui32 level, ui32 x, ui32 y, ui32 z) const {
+    if (is_uniform()) return m_uniform_solid;
+
+    return get_bit(level, x, y, z);
+}
+
+bool hvox::ChunkOccupancyPyramid::any_solid(BlockChunkPosition start, BlockChunkPosition end) const {
+    if (is_uniform()) return m_uniform_solid;
+
+    return any_solid(LEVEL_COUNT - 1, 0, 0, 0, glm::min(start, end), glm::max(start, end));
+}
+
+void hvox::ChunkOccupancyPyramid::set_bit(ui32 level, ui32 x, ui32 y, ui32 z, bool solid) {
+    const size_t bit  = bit_index(level, x, y, z);
+    ui64&        word = m_bits[LEVEL_OFFSETS[level] + bit / 64];
+
+    if (solid) {
+        word |= ui64{1} << (bit % 64);
+    } else {
+        word &= ~(ui64{1} << (bit % 64));
+    }
+}
+
+bool hvox::ChunkOccupancyPyramid::any_child_solid(ui32 level, ui32 x, ui32 y, ui32 z) const {
+    const ui32   child_level = level - 1;
+    const ui64*  child_words = m_bits + LEVEL_OFFSETS[child_level];
+
+    // Children come in pairs along x starting at an even bit,
+    // so each pair sits within a single word.
+    for (ui32 dz = 0; dz < 2; ++dz) {
+        for (ui32 dy = 0; dy < 2; ++dy) {
+            const size_t bit = bit_index(child_level, 2 * x, 2 * y + dy, 2 * z + dz);
+
+            if ((child_words[bit / 64] >> (bit % 64)) & 3) return true;
+        }
+    }
+
+    return false;
+}
+
+void hvox::ChunkOccupancyPyramid::expand() {
+    m_bits = new ui64[WORD_COUNT];
+
+    std::fill_n(m_bits, WORD_COUNT, m_uniform_solid ? ~ui64{0} : ui64{0});
+}
+
+bool hvox::ChunkOccupancyPyramid::any_solid(
+                  ui32 level,
+                  ui32 x,
+                  ui32 y,
+                  ui32 z,
+    BlockChunkPosition start,
+    BlockChunkPosition end
+) const {
+    if (!get_bit(level, x, y, z)) return false;
+
+    const ui32v3 cell_start = ui32v3{ x, y, z } << level;
+    const ui32v3 cell_end   = cell_start + ((1u << level) - 1u);
+
+    // A solid cell lying wholly within the cuboid means some
+    // block within the cuboid is solid.
+    if (glm::all(glm::greaterThanEqual(cell_start, ui32v3(start)))
+            && glm::all(glm::lessThanEqual(cell_end, ui32v3(end)))) return true;
+
+    // Otherwise only the children overlapping the cuboid are of
+    // interest.
+    const ui32 child_level = level - 1;
+    const ui32 half        = 1u << child_level;
+
+    for (ui32 dz = 0; dz < 2; ++dz) {
+        const ui32 z_start = cell_start.z + dz * half;
+        if (z_start > end.z || z_start + half - 1 < start.z) continue;
+
+        for (ui32 dy = 0; dy < 2; ++dy) {
+            const ui32 y_start = cell_start.y + dy * half;
+            if (y_start > end.y || y_start + half - 1 < start.y) continue;
+
+            for (ui32 dx = 0; dx < 2; ++dx) {
+                const ui32 x_start = cell_start.x + dx * half;
+                if (x_start > end.x || x_start + half - 1 < start.x) continue;
+
+                if (any_solid(child_level, 2 * x + dx, 2 * y + dy, 2 * z + dz, start, end)) return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -6,6 +6,45 @@
 #include "voxel/chunk/renderer.h"
 
 hg::MeshHandles hvox::ChunkRenderer::block_mesh_handles = {};
+GLuint          hvox::ChunkRenderer::quad_vao           = 0;
+
+static const GLuint QUAD_BUFFER_BINDING = 0;
+static const ui32   QUAD_VERTEX_COUNT   = 6;
+
+static const GLuint INDIRECT_POSITION_ATTRIBUTE = 0;
+static const GLuint CULL_COMMAND_BINDING        = 1;
+static const GLuint CULL_POSITION_BINDING       = 2;
+static const GLuint CULL_OUTPUT_BINDING         = 3;
+static const ui32   CULL_GROUP_SIZE             = 64;
+
+// Ranges given to chunks are rounded up to a multiple of
+// this many instances, so that most remeshes fit in place.
+static const ui32 PAGE_RANGE_GRANULARITY = 64;
+// A page is compacted once at least this fraction of it
+// lies unused between the chunks in it.
+static const ui32 PAGE_COMPACTION_DIVISOR = 4;
+// Number of meshes that can be staged at once. Released
+// blocks wait on a fence before reuse, so this wants to
+// cover a few updates' worth of remeshing.
+static const ui32 STAGING_BLOCK_COUNT = 24;
+// Chunks are bucketed into pages by regions of this many
+// chunks along each axis, so that pages can be culled.
+static const i64 PAGE_REGION_LENGTH = 4;
+
+static inline i64 floor_div(i64 numerator, i64 denominator) {
+    return (numerator >= 0 ? numerator : numerator - (denominator - 1)) / denominator;
+}
+
+static inline hvox::ChunkGridPosition page_region(hvox::ChunkGridPosition chunk_position) {
+    hvox::ChunkGridPosition region;
+    region.id = 0;
+
+    region.x = floor_div(chunk_position.x, PAGE_REGION_LENGTH);
+    region.y = floor_div(chunk_position.y, PAGE_REGION_LENGTH);
+    region.z = floor_div(chunk_position.z, PAGE_REGION_LENGTH);
+
+    return region;
+}
 
 hvox::ChunkRenderer::ChunkRenderer() :
     handle_chunk_mesh_change(Subscriber<>{
@@ -34,11 +73,34 @@ hvox::ChunkRenderer::ChunkRenderer() :
             m_chunk_removal_queue.enqueue({ handle, chunk->id() });
         }
     }),
-    m_page_size(0)
+    m_page_size(0),
+    m_mesh_output(ChunkMeshOutput::CUBOID_INSTANCES),
+    m_draw_mode(ChunkDrawMode::PER_PAGE),
+    m_page_buffer(0),
+    m_draw_commands_dirty(false),
+    m_draw_command_capacity(0),
+    m_command_buffer(0),
+    m_culled_command_buffer(0),
+    m_position_buffer(0),
+    m_indirect_vao(0),
+    m_cull_program(0)
 { /* Empty. */ }
 
-void hvox::ChunkRenderer::init(ui32 page_size, ui32 max_unused_pages) {
-    if (block_mesh_handles.vao == 0) {
+void hvox::ChunkRenderer::init( ui32 page_size,
+                                ui32 max_unused_pages,
+                     ChunkMeshOutput mesh_output /*= ChunkMeshOutput::CUBOID_INSTANCES*/,
+                       ChunkDrawMode draw_mode   /*= ChunkDrawMode::PER_PAGE*/ )
+{
+    m_mesh_output = mesh_output;
+    m_draw_mode   = draw_mode;
+
+    // Quads are pulled straight from the page buffers, but
+    // a vertex array must still be bound to draw.
+    if (m_mesh_output == ChunkMeshOutput::FACE_QUADS && quad_vao == 0) {
+        glCreateVertexArrays(1, &quad_vao);
+    }
+
+    if (m_mesh_output == ChunkMeshOutput::CUBOID_INSTANCES && block_mesh_handles.vao == 0) {
         hg::upload_mesh(BLOCK_MESH, block_mesh_handles, hg::MeshDataVolatility::STATIC);
 
         glEnableVertexArrayAttrib(block_mesh_handles.vao,  3);
@@ -52,9 +114,29 @@ void hvox::ChunkRenderer::init(ui32 page_size, ui32 max_unused_pages) {
         glVertexArrayBindingDivisor(block_mesh_handles.vao, 1, 1);
     }
 
+    // Each draw command's base instance picks out the position
+    // of its chunk.
+    if (m_mesh_output == ChunkMeshOutput::FACE_QUADS && m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) {
+        glCreateVertexArrays(1, &m_indirect_vao);
+
+        glEnableVertexArrayAttrib(m_indirect_vao,  INDIRECT_POSITION_ATTRIBUTE);
+        glVertexArrayAttribIFormat(m_indirect_vao, INDIRECT_POSITION_ATTRIBUTE, 3, GL_INT, 0);
+        glVertexArrayAttribBinding(m_indirect_vao, INDIRECT_POSITION_ATTRIBUTE, 0);
+
+        glVertexArrayBindingDivisor(m_indirect_vao, 0, 1);
+    }
+
     m_page_size        = page_size;
     m_max_unused_pages = max_unused_pages;
 
+    // Blocks are sized to the largest mesh a chunk can have.
+    m_staging_buffer = hmem::make_handle<ChunkStagingBuffer>();
+    m_staging_buffer->init(
+        m_mesh_output == ChunkMeshOutput::FACE_QUADS ?
+            CHUNK_VOLUME * 3 * sizeof(ChunkQuadData) : CHUNK_VOLUME / 2 * sizeof(ChunkInstanceData),
+        STAGING_BLOCK_COUNT
+    );
+
     // Create pages up to max unused pages so we don't
     // do as much allocation later. 
     create_pages(m_max_unused_pages);
@@ -63,9 +145,35 @@ void hvox::ChunkRenderer::init(ui32 page_size, ui32 max_unused_pages) {
 void hvox::ChunkRenderer::dispose() {
     m_page_size = 0;
 
-    for (auto& chunk_page : m_chunk_pages) {
-        glDeleteBuffers(1, &chunk_page->vbo);
+    m_staging_buffer->dispose();
+    m_staging_buffer = nullptr;
+
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) {
+        glDeleteBuffers(1, &m_page_buffer);
+        m_page_buffer = 0;
+
+        glDeleteBuffers(1, &m_command_buffer);
+        glDeleteBuffers(1, &m_culled_command_buffer);
+        glDeleteBuffers(1, &m_position_buffer);
+        m_command_buffer        = 0;
+        m_culled_command_buffer = 0;
+        m_position_buffer       = 0;
+        m_draw_command_capacity = 0;
+
+        if (m_indirect_vao != 0) {
+            glDeleteVertexArrays(1, &m_indirect_vao);
+            m_indirect_vao = 0;
+        }
+
+        ChunkDrawCommands().swap(m_draw_commands);
+        std::vector<i32v4>().swap(m_draw_positions);
+        PagedChunks().swap(m_draw_chunks);
+    } else {
+        for (auto& chunk_page : m_chunk_pages) {
+            glDeleteBuffers(1, &chunk_page->vbo);
+        }
     }
+
     ChunkRenderPages().swap(m_chunk_pages);
 }
 
@@ -83,17 +191,227 @@ void hvox::ChunkRenderer::update(FrameTime) {
     process_pages();
 }
 
-void hvox::ChunkRenderer::draw(FrameTime) {
+void hvox::ChunkRenderer::draw(FrameTime, const f32m4& view_projection) {
+    m_frustum.update(view_projection);
+
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) {
+        draw_indirect();
+        return;
+    }
+
+    if (m_mesh_output == ChunkMeshOutput::FACE_QUADS) {
+        draw_quads();
+        return;
+    }
+
     glBindVertexArray(block_mesh_handles.vao);
     for (auto& chunk_page : m_chunk_pages) {
         if (chunk_page->voxel_count == 0) continue;
 
+        if (!page_in_frustum(*chunk_page)) continue;
+
         glVertexArrayVertexBuffer(block_mesh_handles.vao, 1, chunk_page->vbo, 0, sizeof(ChunkInstanceData));
 
         glDrawArraysInstanced(GL_TRIANGLES, 0, BLOCK_VERTEX_COUNT, chunk_page->voxel_count);
     }
 }
 
+void hvox::ChunkRenderer::draw_quads() {
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+    GLint chunk_position_location = glGetUniformLocation(static_cast<GLuint>(program), "chunk_position");
+
+    glBindVertexArray(quad_vao);
+    for (auto& chunk_page : m_chunk_pages) {
+        ChunkRenderPage& page = *chunk_page;
+        if (page.voxel_count == 0) continue;
+
+        if (!page_in_frustum(page)) continue;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUAD_BUFFER_BINDING, page.vbo);
+
+        for (ChunkID id : page.chunks) {
+            auto it = m_chunk_metadata.find(id);
+            if (it == m_chunk_metadata.end()) continue;
+
+            const PagedChunkMetadata& metadata = it->second;
+
+            if (metadata.on_gpu_voxel_count == 0) continue;
+
+            ChunkGridPosition chunk_position;
+            chunk_position.id = id;
+
+            BlockWorldPosition origin = block_world_position(chunk_position, 0);
+
+            if (!m_frustum.intersects(f32v3{origin}, f32v3{origin + BlockWorldPosition{CHUNK_LENGTH}}))
+                continue;
+
+            glUniform3iv(chunk_position_location, 1, &origin[0]);
+
+            glDrawArrays(
+                GL_TRIANGLES,
+                static_cast<GLint>(metadata.on_gpu_offset * QUAD_VERTEX_COUNT),
+                static_cast<GLsizei>(metadata.on_gpu_voxel_count * QUAD_VERTEX_COUNT)
+            );
+        }
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUAD_BUFFER_BINDING, 0);
+}
+
+void hvox::ChunkRenderer::draw_indirect() {
+    if (m_draw_commands.empty()) return;
+
+    const GLsizei draw_count = static_cast<GLsizei>(m_draw_commands.size());
+
+    GLuint command_buffer = m_command_buffer;
+
+    if (m_cull_program != 0) {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+        glUseProgram(m_cull_program);
+
+        glUniform4fv(
+            glGetUniformLocation(m_cull_program, "frustum_planes"),
+            6, &m_frustum.planes()[0][0]
+        );
+        glUniform1ui(
+            glGetUniformLocation(m_cull_program, "command_count"),
+            static_cast<GLuint>(draw_count)
+        );
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_COMMAND_BINDING,  m_command_buffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_POSITION_BINDING, m_position_buffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_OUTPUT_BINDING,   m_culled_command_buffer);
+
+        glDispatchCompute((static_cast<GLuint>(draw_count) + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+        // Commands must be written before they are drawn.
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_COMMAND_BINDING,  0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_POSITION_BINDING, 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_OUTPUT_BINDING,   0);
+
+        glUseProgram(static_cast<GLuint>(program));
+
+        command_buffer = m_culled_command_buffer;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+
+    if (m_mesh_output == ChunkMeshOutput::FACE_QUADS) {
+        glVertexArrayVertexBuffer(m_indirect_vao, 0, m_position_buffer, 0, sizeof(i32v4));
+        glBindVertexArray(m_indirect_vao);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUAD_BUFFER_BINDING, m_page_buffer);
+
+        glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, draw_count, 0);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUAD_BUFFER_BINDING, 0);
+    } else {
+        glBindVertexArray(block_mesh_handles.vao);
+        glVertexArrayVertexBuffer(block_mesh_handles.vao, 1, m_page_buffer, 0, sizeof(ChunkInstanceData));
+
+        glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, draw_count, 0);
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void hvox::ChunkRenderer::add_draw_command(ChunkID chunk_id) {
+    PagedChunkMetadata& metadata = m_chunk_metadata[chunk_id];
+
+    ChunkGridPosition chunk_position;
+    chunk_position.id = chunk_id;
+
+    metadata.draw_idx = static_cast<ui32>(m_draw_commands.size());
+
+    m_draw_commands.emplace_back(ChunkDrawCommand{});
+    m_draw_positions.emplace_back(i32v4{block_world_position(chunk_position, 0), 0});
+    m_draw_chunks.emplace_back(chunk_id);
+
+    update_draw_command(metadata);
+}
+
+void hvox::ChunkRenderer::remove_draw_command(ChunkID chunk_id) {
+    const ui32 draw_idx = m_chunk_metadata[chunk_id].draw_idx;
+
+    // As with chunks in pages, swap the last command into the
+    // removed command's place.
+    if (draw_idx != m_draw_commands.size() - 1) {
+        m_draw_commands[draw_idx]  = m_draw_commands.back();
+        m_draw_positions[draw_idx] = m_draw_positions.back();
+        m_draw_chunks[draw_idx]    = m_draw_chunks.back();
+
+        PagedChunkMetadata& moved = m_chunk_metadata[m_draw_chunks[draw_idx]];
+        moved.draw_idx = draw_idx;
+
+        // Quads find their chunk's position by base instance,
+        // which is the index of the command.
+        update_draw_command(moved);
+    }
+    m_draw_commands.pop_back();
+    m_draw_positions.pop_back();
+    m_draw_chunks.pop_back();
+
+    m_draw_commands_dirty = true;
+}
+
+void hvox::ChunkRenderer::update_draw_command(const PagedChunkMetadata& metadata) {
+    const ui32 first = m_chunk_pages[metadata.page_idx]->base + metadata.on_gpu_offset;
+
+    ChunkDrawCommand& command = m_draw_commands[metadata.draw_idx];
+
+    if (m_mesh_output == ChunkMeshOutput::FACE_QUADS) {
+        command.count          = metadata.on_gpu_voxel_count * QUAD_VERTEX_COUNT;
+        command.instance_count = 1;
+        command.first          = first * QUAD_VERTEX_COUNT;
+        command.base_instance  = metadata.draw_idx;
+    } else {
+        command.count          = BLOCK_VERTEX_COUNT;
+        command.instance_count = metadata.on_gpu_voxel_count;
+        command.first          = 0;
+        command.base_instance  = first;
+    }
+
+    m_draw_commands_dirty = true;
+}
+
+void hvox::ChunkRenderer::upload_draw_commands() {
+    if (!m_draw_commands_dirty) return;
+
+    m_draw_commands_dirty = false;
+
+    if (m_draw_commands.size() > m_draw_command_capacity) {
+        glDeleteBuffers(1, &m_command_buffer);
+        glDeleteBuffers(1, &m_culled_command_buffer);
+        glDeleteBuffers(1, &m_position_buffer);
+
+        m_draw_command_capacity = std::max(
+            static_cast<ui32>(m_draw_commands.size()), 2 * m_draw_command_capacity
+        );
+
+        glCreateBuffers(1, &m_command_buffer);
+        glNamedBufferData(m_command_buffer, m_draw_command_capacity * sizeof(ChunkDrawCommand), nullptr, GL_DYNAMIC_DRAW);
+
+        glCreateBuffers(1, &m_culled_command_buffer);
+        glNamedBufferData(m_culled_command_buffer, m_draw_command_capacity * sizeof(ChunkDrawCommand), nullptr, GL_DYNAMIC_COPY);
+
+        glCreateBuffers(1, &m_position_buffer);
+        glNamedBufferData(m_position_buffer, m_draw_command_capacity * sizeof(i32v4), nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    if (m_draw_commands.empty()) return;
+
+    // TODO(Matthew): We upload all commands on any change, which is
+    //                fine so long as chunks change far less often
+    //                than we draw. If not, track a dirty range.
+    glNamedBufferSubData(m_command_buffer,  0, m_draw_commands.size()  * sizeof(ChunkDrawCommand), m_draw_commands.data());
+    glNamedBufferSubData(m_position_buffer, 0, m_draw_positions.size() * sizeof(i32v4),            m_draw_positions.data());
+}
+
 void hvox::ChunkRenderer::add_chunk(hmem::WeakHandle<Chunk> handle) {
     auto chunk = handle.lock();
 
@@ -115,281 +433,424 @@ hvox::ChunkRenderPage* hvox::ChunkRenderer::create_pages(ui32 count) {
      * memory saving up-front, and none for a long-running session.
      */
 
-    /**************************\
-     * Append first new page. *
-    \**************************/
+    size_t first_new_page_idx = m_chunk_pages.size();
 
-    m_chunk_pages.emplace_back(new ChunkRenderPage{});
+    const size_t page_bytes = block_page_size() * mesh_element_size();
 
-    ChunkRenderPage* first_new_page = m_chunk_pages.back();
+    // Pages sharing one buffer grow it, carrying over the
+    // contents of the pages that already exist.
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) {
+        GLuint buffer;
+        glCreateBuffers(1, &buffer);
+        glNamedBufferData(buffer, (first_new_page_idx + count) * page_bytes, nullptr, GL_DYNAMIC_DRAW);
 
-    glCreateBuffers(1, &first_new_page->vbo);
-    glNamedBufferData(first_new_page->vbo, block_page_size() * sizeof(ChunkInstanceData), nullptr, GL_DYNAMIC_DRAW);
+        if (m_page_buffer != 0) {
+            glCopyNamedBufferSubData(m_page_buffer, buffer, 0, 0, first_new_page_idx * page_bytes);
 
-    first_new_page->chunks.reserve(m_page_size);
+            glDeleteBuffers(1, &m_page_buffer);
+        }
+
+        m_page_buffer = buffer;
+
+        for (auto& page : m_chunk_pages) page->vbo = m_page_buffer;
+    }
 
-    /********************************\
-     * Append subsequent new pages. *
-    \********************************/
     for (ui32 i = 0; i < count; ++i) {
+        const ui32 page_idx = static_cast<ui32>(m_chunk_pages.size());
+
         m_chunk_pages.emplace_back(new ChunkRenderPage{});
 
         ChunkRenderPage* new_page = m_chunk_pages.back();
 
-        glCreateBuffers(1, &new_page->vbo);
-        glNamedBufferData(new_page->vbo, block_page_size() * sizeof(ChunkInstanceData), nullptr, GL_DYNAMIC_DRAW);
+        if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) {
+            new_page->vbo  = m_page_buffer;
+            new_page->base = page_idx * block_page_size();
+        } else {
+            glCreateBuffers(1, &new_page->vbo);
+            glNamedBufferData(new_page->vbo, page_bytes, nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        new_page->free_ranges.emplace_back(ChunkRenderPageRange{ 0, block_page_size() });
+
+        clear_range(*new_page, 0, block_page_size());
 
         new_page->chunks.reserve(m_page_size);
     }
 
     // Return pointer to the first page created.
-    return first_new_page;
+    return m_chunk_pages[first_new_page_idx];
 }
 
-void hvox::ChunkRenderer::put_chunk_in_page(ChunkID chunk_id, ui32 instance_count, ui32 first_page_idx) {
+void hvox::ChunkRenderer::put_chunk_in_page(ChunkID chunk_id, ui32 instance_count) {
     PagedChunkMetadata& metadata = m_chunk_metadata[chunk_id];
 
-    ui32 page_idx = first_page_idx;
-    ChunkRenderPage* page = nullptr;
+    assert(instance_count <= block_page_size());
+
+    // Leave some room for the chunk to grow in place when
+    // next remeshed.
+    ui32 capacity = std::min(
+        (instance_count + PAGE_RANGE_GRANULARITY - 1) / PAGE_RANGE_GRANULARITY * PAGE_RANGE_GRANULARITY,
+        block_page_size()
+    );
+
+    ChunkGridPosition chunk_position;
+    chunk_position.id = chunk_id;
+
+    ChunkGridPosition region = page_region(chunk_position);
+
+    ui32 offset   = 0;
+    ui32 page_idx = 0;
     for (; page_idx < m_chunk_pages.size(); ++page_idx) {
-        if (m_chunk_pages[page_idx]->voxel_count + instance_count <= block_page_size()) {
-            page = m_chunk_pages[page_idx];
-            break;
+        ChunkRenderPage& page = *m_chunk_pages[page_idx];
+
+        if (page.chunks.empty() || page.region.id != region.id) continue;
+
+        if (allocate_range(page, capacity, offset)) break;
+    }
+
+    // No page of the chunk's region has room, so claim a page
+    // not being used by any region.
+    if (page_idx == m_chunk_pages.size()) {
+        for (page_idx = 0; page_idx < m_chunk_pages.size(); ++page_idx) {
+            if (m_chunk_pages[page_idx]->chunks.empty()) break;
         }
+
+        if (page_idx == m_chunk_pages.size()) create_pages(1);
+
+        [[maybe_unused]] bool allocated = allocate_range(*m_chunk_pages[page_idx], capacity, offset);
+        assert(allocated);
     }
 
-    if (page == nullptr) {
-        page = create_pages(1);
-        ++page_idx;
+    ChunkRenderPage& page = *m_chunk_pages[page_idx];
+
+    BlockWorldPosition chunk_min = block_world_position(chunk_position, 0);
+    BlockWorldPosition chunk_max = chunk_min + BlockWorldPosition{CHUNK_LENGTH};
+
+    if (page.chunks.empty()) {
+        page.region   = region;
+        page.aabb_min = chunk_min;
+        page.aabb_max = chunk_max;
+    } else {
+        page.aabb_min = glm::min(page.aabb_min, chunk_min);
+        page.aabb_max = glm::max(page.aabb_max, chunk_max);
     }
 
-    ui32 chunk_idx = page->chunks.size();
-    page->chunks.emplace_back(chunk_id);
+    metadata.page_idx           = page_idx;
+    metadata.chunk_idx          = static_cast<ui32>(page.chunks.size());
+    metadata.on_gpu_offset      = offset;
+    metadata.on_gpu_capacity    = capacity;
+    metadata.on_gpu_voxel_count = 0;
+    metadata.paged              = true;
+
+    page.chunks.emplace_back(chunk_id);
 
-    if (page->first_dirtied_chunk_idx >= page->chunks.size()) {
-        page->first_dirtied_chunk_idx  = page->chunks.size() - 1;
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) add_draw_command(chunk_id);
+}
+
+void hvox::ChunkRenderer::remove_chunk_from_page(ChunkID chunk_id) {
+    PagedChunkMetadata& metadata = m_chunk_metadata[chunk_id];
+
+    if (!metadata.paged) return;
+
+    ChunkRenderPage& page = *m_chunk_pages[metadata.page_idx];
+
+    clear_range(page, metadata.on_gpu_offset, metadata.on_gpu_voxel_count);
+
+    free_range(page, metadata.on_gpu_offset, metadata.on_gpu_capacity);
+
+    // Order of chunks in a page is of no consequence, so
+    // swap the last chunk into the removed chunk's place.
+    if (metadata.chunk_idx != page.chunks.size() - 1) {
+        page.chunks[metadata.chunk_idx] = page.chunks.back();
+
+        m_chunk_metadata[page.chunks[metadata.chunk_idx]].chunk_idx = metadata.chunk_idx;
     }
+    page.chunks.pop_back();
 
-    page->voxel_count += instance_count;
+    update_page_aabb(page);
 
-    page->dirty = true;
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) remove_draw_command(chunk_id);
 
-    metadata.chunk_idx = chunk_idx;
-    metadata.page_idx  = page_idx;
-    metadata.paged     = true;
+    metadata.on_gpu_voxel_count = 0;
+    metadata.on_gpu_capacity    = 0;
+    metadata.paged              = false;
 }
 
-void hvox::ChunkRenderer::process_pages() {
-    HandleAndID handle_and_id;
+void hvox::ChunkRenderer::update_page_aabb(ChunkRenderPage& page) {
+    if (page.chunks.empty()) return;
 
-    /*****************\
-     * Remove Chunks *
-    \*****************/
+    page.aabb_min = BlockWorldPosition{std::numeric_limits<BlockWorldPositionCoord>::max()};
+    page.aabb_max = BlockWorldPosition{std::numeric_limits<BlockWorldPositionCoord>::min()};
 
-    while (m_chunk_removal_queue.try_dequeue(handle_and_id)) {
-        auto it = m_chunk_metadata.find(handle_and_id.id);
+    for (ChunkID id : page.chunks) {
+        ChunkGridPosition chunk_position;
+        chunk_position.id = id;
 
-        assert(it != m_chunk_metadata.end());
+        BlockWorldPosition chunk_min = block_world_position(chunk_position, 0);
 
-        PagedChunkMetadata metadata = it->second;
+        page.aabb_min = glm::min(page.aabb_min, chunk_min);
+        page.aabb_max = glm::max(page.aabb_max, chunk_min + BlockWorldPosition{CHUNK_LENGTH});
+    }
+}
 
-        m_chunk_metadata.erase(it);
+bool hvox::ChunkRenderer::allocate_range(ChunkRenderPage& page, ui32 size, OUT ui32& offset) {
+    for (auto it = page.free_ranges.begin(); it != page.free_ranges.end(); ++it) {
+        if (it->size < size) continue;
 
-        if (!metadata.paged) continue;
-
-        ChunkRenderPage& page = *m_chunk_pages[metadata.page_idx];
-
-        // Only do full clean up if the chunk we're removing is not
-        // at the end of the page already.
-        if (metadata.chunk_idx != page.chunks.size() - 1) {
-            std::swap(page.chunks.back(), page.chunks[metadata.chunk_idx]);
-            page.chunks.pop_back();
-
-            // TODO(Matthew): This updates chunk indexes, but feels like it
-            //                isn't the best approach. Perhaps we can do
-            //                better?
-            for (
-                ui32 chunk_idx = metadata.chunk_idx;
-                chunk_idx < page.chunks.size();
-                ++chunk_idx
-            ) {
-                m_chunk_metadata[page.chunks[chunk_idx]].chunk_idx = chunk_idx;
-            }
+        offset = it->offset;
 
-            if (page.first_dirtied_chunk_idx > metadata.chunk_idx) {
-                page.first_dirtied_chunk_idx = metadata.chunk_idx;
-            }
+        it->offset += size;
+        it->size   -= size;
+        if (it->size == 0) page.free_ranges.erase(it);
 
-            // Make sure page is reprocessed.
-            page.dirty = true;
-        } else {
-            page.chunks.pop_back();
+        page.allocated   += size;
+        page.voxel_count  = std::max(page.voxel_count, offset + size);
+
+        return true;
+    }
 
-            // If only dirty chunk was the one we just removed, and
-            // given we just popped the final chunk in the page, we
-            // can mark as clean.
-            if (page.first_dirtied_chunk_idx == metadata.chunk_idx) {
-                page.first_dirtied_chunk_idx = std::numeric_limits<ui32>::max();
+    return false;
+}
 
-                page.dirty = false;
-            }
+void hvox::ChunkRenderer::free_range(ChunkRenderPage& page, ui32 offset, ui32 size) {
+    auto it = std::lower_bound(
+        page.free_ranges.begin(), page.free_ranges.end(), offset,
+        [](const ChunkRenderPageRange& range, ui32 _offset) {
+            return range.offset < _offset;
         }
+    );
 
-        // Deduct removed voxels from page voxel count, allowing
-        // a new chunk to join if extra space permits.
-        page.voxel_count -= metadata.on_gpu_voxel_count;
+    it = page.free_ranges.insert(it, ChunkRenderPageRange{ offset, size });
+
+    // Coalesce with the following range.
+    if (auto next = it + 1; next != page.free_ranges.end() && it->offset + it->size == next->offset) {
+        it->size += next->size;
+        page.free_ranges.erase(next);
     }
 
-    /*****************\
-     * Update Chunks *
-    \*****************/
+    // Coalesce with the preceding range.
+    if (it != page.free_ranges.begin()) {
+        if (auto prev = it - 1; prev->offset + prev->size == it->offset) {
+            prev->size += it->size;
+            it = page.free_ranges.erase(it) - 1;
+        }
+    }
 
-    while (m_chunk_dirty_queue.try_dequeue(handle_and_id)) {
-        auto it = m_chunk_metadata.find(handle_and_id.id);
+    page.allocated -= size;
 
-        if (it == m_chunk_metadata.end())
-            continue;
+    // If the range now runs to the end of the page, the page's
+    // extent shrinks back to its start.
+    if (it->offset + it->size == block_page_size()) page.voxel_count = it->offset;
+}
 
-        PagedChunkMetadata& metadata = it->second;
-        metadata.dirty = true;
+void hvox::ChunkRenderer::clear_range(ChunkRenderPage& page, ui32 offset, ui32 count) {
+    // Quads are drawn chunk by chunk, and so never drawn from
+    // ranges no chunk is using.
+    if (m_mesh_output == ChunkMeshOutput::FACE_QUADS || count == 0) return;
+
+    glClearNamedBufferSubData(
+        page.vbo,
+        GL_R32UI,
+        (page.base + offset) * mesh_element_size(),
+        count  * mesh_element_size(),
+        GL_RED_INTEGER,
+        GL_UNSIGNED_INT,
+        nullptr
+    );
+}
 
-        auto chunk = handle_and_id.handle.lock();
+void hvox::ChunkRenderer::compact_page(ChunkRenderPage& page) {
+    GLuint vbo;
+    glCreateBuffers(1, &vbo);
+    glNamedBufferData(vbo, block_page_size() * mesh_element_size(), nullptr, GL_DYNAMIC_DRAW);
+
+    // Either way, chunks are then copied from the start of vbo
+    // back into the page.
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) {
+        // Pages sharing a buffer are compacted in place, from a
+        // copy of the page.
+        glCopyNamedBufferSubData(
+            page.vbo,
+            vbo,
+            page.base        * mesh_element_size(),
+            0,
+            page.voxel_count * mesh_element_size()
+        );
+    } else {
+        std::swap(page.vbo, vbo);
+    }
 
-        if (metadata.paged) {
-            ChunkRenderPage& page = *m_chunk_pages[metadata.page_idx];
+    clear_range(page, 0, block_page_size());
+
+    std::vector<PagedChunkMetadata*> chunks;
+    chunks.reserve(page.chunks.size());
+    for (ChunkID id : page.chunks) chunks.emplace_back(&m_chunk_metadata[id]);
+
+    // Keep chunks in the order they already were, so
+    // that each only ever moves towards the front.
+    std::sort(chunks.begin(), chunks.end(), [](const PagedChunkMetadata* lhs, const PagedChunkMetadata* rhs) {
+        return lhs->on_gpu_offset < rhs->on_gpu_offset;
+    });
+
+    ui32 cursor = 0;
+    for (auto metadata : chunks) {
+        if (metadata->on_gpu_voxel_count > 0) {
+            glCopyNamedBufferSubData(
+                vbo,
+                page.vbo,
+                metadata->on_gpu_offset      * mesh_element_size(),
+                (page.base + cursor)         * mesh_element_size(),
+                metadata->on_gpu_voxel_count * mesh_element_size()
+            );
+        }
 
-            if (page.first_dirtied_chunk_idx > metadata.chunk_idx) {
-                page.first_dirtied_chunk_idx = metadata.chunk_idx;
-            }
+        metadata->on_gpu_offset = cursor;
 
-            page.dirty = true;
-        } else if (chunk != nullptr) {
-            std::shared_lock<std::shared_mutex> instance_lock;
-            const auto& instance = chunk->instance.get(instance_lock);
+        if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) update_draw_command(*metadata);
 
-            put_chunk_in_page(chunk->id(), instance.count, 0);
-        }
+        cursor += metadata->on_gpu_capacity;
     }
 
+    glDeleteBuffers(1, &vbo);
+
+    page.free_ranges.clear();
+    if (cursor < block_page_size())
+        page.free_ranges.emplace_back(ChunkRenderPageRange{ cursor, block_page_size() - cursor });
+
+    page.voxel_count = cursor;
+}
+
+void hvox::ChunkRenderer::process_pages() {
+    HandleAndID handle_and_id;
+
     /*****************\
-     * Process Pages *
+     * Remove Chunks *
     \*****************/
 
-    // TODO(Matthew): Could change this to simply two VBOs per page, and swap back
-    //                and forth between them. That way we don't keep creating
-    //                new buffer objects (we'd still want to deallocate buffers).
+    while (m_chunk_removal_queue.try_dequeue(handle_and_id)) {
+        auto it = m_chunk_metadata.find(handle_and_id.id);
+
+        assert(it != m_chunk_metadata.end());
 
-    // We will swap all prior-existing pages' VBOs with these.
-    // For undirtied pages this will not actually change their VBO.
-    std::vector<GLuint> new_vbos(m_chunk_pages.size(), 0);
+        remove_chunk_from_page(handle_and_id.id);
 
-    for (ui32 page_idx = 0; page_idx < m_chunk_pages.size(); ++page_idx) {
-        ChunkRenderPage& page = *m_chunk_pages[page_idx];
-        if (!page.dirty) {
-            new_vbos[page_idx] = page.vbo;
+        m_chunk_metadata.erase(it);
+        m_all_paged_chunks.erase(handle_and_id.id);
+    }
+
+    /*****************\
+     * Update Chunks *
+    \*****************/
+
+    // A chunk may be queued more than once, but its new mesh
+    // need only be uploaded the once.
+    std::vector<HandleAndID> dirty_chunks;
+    while (m_chunk_dirty_queue.try_dequeue(handle_and_id)) {
+        auto it = m_chunk_metadata.find(handle_and_id.id);
+
+        if (it == m_chunk_metadata.end() || it->second.dirty)
             continue;
-        }
 
-        assert(page.first_dirtied_chunk_idx < page.chunks.size());
+        it->second.dirty = true;
 
-        // Create a new on-GPU buffer to populate.
-        glCreateBuffers(1, &new_vbos[page_idx]);
-        glNamedBufferData(new_vbos[page_idx], block_page_size() * sizeof(ChunkInstanceData), nullptr, GL_DYNAMIC_DRAW);
+        dirty_chunks.emplace_back(handle_and_id);
+    }
 
-        ui32 voxels_instanced = 0;
-        for (ui32 chunk_idx = 0; chunk_idx < page.first_dirtied_chunk_idx; ++chunk_idx) {
-            voxels_instanced += m_chunk_metadata[page.chunks[chunk_idx]].on_gpu_voxel_count;
-        }
+    for (auto& dirty_chunk : dirty_chunks) {
+        PagedChunkMetadata& metadata = m_chunk_metadata[dirty_chunk.id];
+        metadata.dirty = false;
 
-        // Copy unchanged original data into new buffer.
-        glCopyNamedBufferSubData(page.vbo, new_vbos[page_idx], 0, 0, voxels_instanced * sizeof(ChunkInstanceData));
+        auto chunk = dirty_chunk.handle.lock();
 
-        for (ui32 chunk_idx = page.first_dirtied_chunk_idx; chunk_idx < page.chunks.size();) {
-            ChunkID id = page.chunks[chunk_idx];
+        // "Dirty" chunk that has ceased to exist, it will
+        // have been added to the removal queue.
+        if (chunk == nullptr) continue;
 
-            auto it = m_chunk_metadata.find(id);
-            assert(it != m_chunk_metadata.end());
-            PagedChunkMetadata& metadata = it->second;
-
-            auto chunk = m_all_paged_chunks[id].lock();
-
-            // "Dirty" chunk that has ceased to exist, can't
-            // update it so drop it. Don't need to do anything
-            // special as it will have been added to the removal
-            // queue.
-            if (chunk == nullptr) continue;
-
-            // Is chunk actually dirty (i.e. does a new set of instance
-            // data exist to upload to the GPU), or can we copy its previous
-            // data from wherever that lies on the GPU?
-            if (metadata.dirty) {
-                std::shared_lock<std::shared_mutex> instance_lock;
-                const auto& instance = chunk->instance.get(instance_lock);
-
-                assert(instance.count <= block_page_size());
-
-                // Check chunk still fits in this page, if not, remove it and place
-                // it in a page that might still have space for it (else creating a
-                // new page for it).
-                if (voxels_instanced + instance.count > block_page_size()) {
-                    // Swap non-fitting chunk with last chunk in page, pop it,
-                    // and update the metadata for the chunk that we swapped in.
-                    std::swap(page.chunks[chunk_idx], page.chunks.back());
-                    page.chunks.pop_back();
-                    metadata.chunk_idx = chunk_idx;
-
-                    // TODO(Matthew): Does this lead to too much memory use? Perhaps
-                    //                do a shuffle phase to fit all chunks and then
-                    //                do the instance data processing logic.
-                    put_chunk_in_page(chunk->id(), instance.count, page_idx + 1);
-
-                    // We don't want to do any more processing of this chunk just yet.
-                    // chunk_idx now indexes to what was previously the last chunk in
-                    // this page.
-                    continue;
-                }
+        std::shared_lock<std::shared_mutex> instance_lock;
+        const auto& instance = chunk->instance.get(instance_lock);
 
-                glNamedBufferSubData(
-                    new_vbos[page_idx],
-                    voxels_instanced * sizeof(ChunkInstanceData),
-                    instance.count   * sizeof(ChunkInstanceData),
-                    reinterpret_cast<void*>(instance.data)
-                );
-                metadata.on_gpu_offset      = voxels_instanced;
-                metadata.on_gpu_page_idx    = page_idx;
-                metadata.on_gpu_voxel_count = instance.count;
+        // No new mesh to upload.
+        if (mesh_element_data(instance) == nullptr) continue;
 
-                voxels_instanced += instance.count;
+        const ui32 instance_count = mesh_element_count(instance);
 
-                metadata.dirty = false;
-            } else {
+        // Chunks with nothing to draw needn't hold onto any
+        // of a page.
+        if (instance_count == 0) {
+            remove_chunk_from_page(dirty_chunk.id);
+        } else {
+            // If the chunk's range can't hold its new mesh, give
+            // up that range and find it a new one.
+            if (metadata.paged && instance_count > metadata.on_gpu_capacity)
+                remove_chunk_from_page(dirty_chunk.id);
+
+            if (!metadata.paged)
+                put_chunk_in_page(dirty_chunk.id, instance_count);
+
+            ChunkRenderPage& page = *m_chunk_pages[metadata.page_idx];
+
+            if (m_staging_buffer->owns(mesh_element_data(instance))) {
                 glCopyNamedBufferSubData(
-                    m_chunk_pages[metadata.on_gpu_page_idx]->vbo,
-                    new_vbos[page_idx],
-                    metadata.on_gpu_offset      * sizeof(ChunkInstanceData),
-                    voxels_instanced            * sizeof(ChunkInstanceData),
-                    metadata.on_gpu_voxel_count * sizeof(ChunkInstanceData)
+                    m_staging_buffer->buffer(),
+                    page.vbo,
+                    m_staging_buffer->offset_of(mesh_element_data(instance)),
+                    (page.base + metadata.on_gpu_offset) * mesh_element_size(),
+                    instance_count         * mesh_element_size()
+                );
+            } else {
+                glNamedBufferSubData(
+                    page.vbo,
+                    (page.base + metadata.on_gpu_offset) * mesh_element_size(),
+                    instance_count         * mesh_element_size(),
+                    mesh_element_data(instance)
                 );
-                metadata.on_gpu_offset      = voxels_instanced;
-                metadata.on_gpu_page_idx    = page_idx;
+            }
 
-                voxels_instanced += metadata.on_gpu_voxel_count;
+            // Zero any of the previous mesh that went beyond the
+            // new one.
+            if (instance_count < metadata.on_gpu_voxel_count) {
+                clear_range(
+                    page,
+                    metadata.on_gpu_offset + instance_count,
+                    metadata.on_gpu_voxel_count - instance_count
+                );
             }
 
-            chunk->instance.free_buffer();
+            metadata.on_gpu_voxel_count = instance_count;
 
-            ++chunk_idx;
+            if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) update_draw_command(metadata);
         }
 
-        page.voxel_count = voxels_instanced;
-        page.dirty = false;
-        page.first_dirtied_chunk_idx = std::numeric_limits<ui32>::max();
+        instance_lock.unlock();
+
+        chunk->instance.free_buffer();
     }
 
-    for (ui32 page_idx = 0; page_idx < new_vbos.size(); ++page_idx) {
-        if (new_vbos[page_idx] != m_chunk_pages[page_idx]->vbo) {
-            glDeleteBuffers(1, &m_chunk_pages[page_idx]->vbo);
-            m_chunk_pages[page_idx]->vbo = new_vbos[page_idx];
+    // Staging blocks released above can be reused once the
+    // copies out of them are done.
+    m_staging_buffer->fence();
+
+    /*****************\
+     * Compact Pages *
+    \*****************/
+
+    // TODO(Matthew): Compacting a page still copies all of it,
+    //                perhaps we want to spread that out by moving
+    //                just a few chunks each update.
+
+    ChunkRenderPage* most_fragmented_page = nullptr;
+    ui32             most_unused          = 0;
+    for (auto& page : m_chunk_pages) {
+        ui32 unused = page->voxel_count - page->allocated;
+
+        if (unused > most_unused) {
+            most_fragmented_page = page;
+            most_unused          = unused;
         }
     }
+
+    if (most_fragmented_page && most_unused >= block_page_size() / PAGE_COMPACTION_DIVISOR)
+        compact_page(*most_fragmented_page);
+
+    if (m_draw_mode == ChunkDrawMode::MULTI_DRAW_INDIRECT) upload_draw_commands();
 }
@@ -0,0 +1,99 @@
+#include "stdafx.h"
+
+#include "voxel/chunk.h"
+
+#include "voxel/chunk/slot_map.h"
+
+hvox::ChunkSlotMap::ChunkSlotMap() :
+    m_slot_count(0),
+    m_grace_period(0),
+    m_pinned_tasks{0, 0}
+{ /* Empty. */ }
+
+void hvox::ChunkSlotMap::dispose() {
+    for (auto& page : m_pages) page.reset();
+
+    m_slot_count = 0;
+    std::vector<ui32>().swap(m_free_slots);
+
+    m_grace_period = 0;
+    for (ui32 i = 0; i < 2; ++i) {
+        m_pinned_tasks[i].store(0, std::memory_order_relaxed);
+        std::vector<ui32>().swap(m_released_slots[i]);
+    }
+}
+
+hvox::ChunkSlotHandle hvox::ChunkSlotMap::acquire(hmem::Handle<Chunk> chunk) {
+    ui32 index;
+    if (!m_free_slots.empty()) {
+        index = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        if (m_slot_count == SLOT_PAGE_SIZE * MAX_SLOT_PAGES) return { 0, 0 };
+
+        index = m_slot_count++;
+
+        auto& page = m_pages[index / SLOT_PAGE_SIZE];
+        if (page == nullptr) {
+            page = std::make_unique<Slot[]>(SLOT_PAGE_SIZE);
+
+            for (ui32 i = 0; i < SLOT_PAGE_SIZE; ++i)
+                page[i].generation.store(1, std::memory_order_relaxed);
+        }
+    }
+
+    Slot& slot = slot_at(index);
+
+    slot.chunk  = chunk.get();
+    slot.handle = chunk;
+
+    // NOTE(Matthew): other threads only come by the handle through
+    //                the release of a neighbour link or a queued
+    //                task, which publishes the chunk set here.
+    return { index, slot.generation.load(std::memory_order_relaxed) };
+}
+
+void hvox::ChunkSlotMap::release(ChunkSlotHandle handle) {
+    if (handle.generation == 0) return;
+
+    Slot& slot = slot_at(handle.index);
+    if (slot.generation.load(std::memory_order_relaxed) != handle.generation) return;
+
+    // Generation zero is reserved for null handles.
+    ui32 generation = handle.generation + 1;
+    if (generation == 0) generation = 1;
+
+    slot.generation.store(generation, std::memory_order_release);
+
+    m_released_slots[m_grace_period].emplace_back(handle.index);
+}
+
+ui32 hvox::ChunkSlotMap::pin() {
+    m_pinned_tasks[m_grace_period].fetch_add(1, std::memory_order_relaxed);
+
+    return m_grace_period;
+}
+
+void hvox::ChunkSlotMap::unpin(ui32 grace_period) {
+    m_pinned_tasks[grace_period].fetch_sub(1, std::memory_order_release);
+}
+
+void hvox::ChunkSlotMap::reclaim() {
+    const ui32 previous = m_grace_period ^ 1;
+
+    // Tasks pinned in the previous grace period may still be
+    // using chunks released in it.
+    if (m_pinned_tasks[previous].load(std::memory_order_acquire) != 0) return;
+
+    for (auto index : m_released_slots[previous]) {
+        Slot& slot = slot_at(index);
+
+        slot.chunk = nullptr;
+        slot.handle.reset();
+
+        m_free_slots.emplace_back(index);
+    }
+    m_released_slots[previous].clear();
+
+    m_grace_period = previous;
+}
@@ -67,6 +67,16 @@ hvox::ChunkGridPosition hvox::chunk_grid_position(BlockWorldPosition block_world
     };
 }
 
+hvox::ColumnWorldPosition hvox::column_world_position(ChunkGridPosition chunk_grid_position) {
+    ColumnWorldPosition column;
+    column.id = 0;
+
+    column.x = static_cast<i32>(chunk_grid_position.x) * CHUNK_LENGTH;
+    column.z = static_cast<i32>(chunk_grid_position.z) * CHUNK_LENGTH;
+
+    return column;
+}
+
 bool operator==(hvox::ColumnWorldPosition lhs, hvox::ColumnWorldPosition rhs) {
     return lhs.id == rhs.id;
 }
@@ -1,15 +1,10 @@
 #include "stdafx.h"
 
 #include "io/iomanager.h"
+#include "voxel/io/region_store.h"
 
 #include "voxel/io/chunk_save_task.h"
 
-// static const char* REMOVE_ME = "REMOVE_ME_ASAAAAP";
-
-// void hvox::ChunkSaveTask::execute(ChunkFileTaskThreadState*, ChunkFileTaskTaskQueue*) {
-//     if (!chunk_data_file.is_open()) {
-//         m_iomanager->memory_map_file(hio::fs::path(REMOVE_ME), chunk_data_file);
-//     }
-
-    
-// }
+void hvox::ChunkSaveTask::execute(ChunkFileTaskThreadState*, ChunkFileTaskTaskQueue*) {
+    m_region_store->write_pending(m_chunk_position);
+}
@@ -0,0 +1,330 @@
+#include "stdafx.h"
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "io/iomanager.h"
+#include "voxel/chunk.h"
+#include "voxel/io/chunk_save_task.h"
+
+#include "voxel/io/region_store.h"
+
+namespace bio = boost::iostreams;
+
+static const ui32 REGION_FILE_MAGIC   = 0x4e475248; // "HRGN"
+static const ui32 REGION_FILE_VERSION = 1;
+
+static const size_t REGION_FILE_HEADER_SIZE = 2 * sizeof(ui32) + REGION_VOLUME * sizeof(hvox::RegionFileEntry);
+
+// Payloads are given capacity in multiples of this, so
+// that a chunk growing slightly can still be rewritten
+// in place.
+static const ui32 REGION_FILE_PAYLOAD_ALIGNMENT = 512;
+
+static inline i64 floor_div(i64 numerator, i64 denominator) {
+    return (numerator >= 0 ? numerator : numerator - (denominator - 1)) / denominator;
+}
+
+static inline hvox::ChunkGridPosition region_position(hvox::ChunkGridPosition chunk_position) {
+    hvox::ChunkGridPosition position;
+    position.id = 0;
+
+    position.x = floor_div(chunk_position.x, REGION_LENGTH);
+    position.y = floor_div(chunk_position.y, REGION_LENGTH);
+    position.z = floor_div(chunk_position.z, REGION_LENGTH);
+
+    return position;
+}
+
+static inline size_t region_entry_offset(hvox::ChunkGridPosition chunk_position, hvox::ChunkGridPosition region_position) {
+    i64 x = chunk_position.x - region_position.x * REGION_LENGTH;
+    i64 y = chunk_position.y - region_position.y * REGION_LENGTH;
+    i64 z = chunk_position.z - region_position.z * REGION_LENGTH;
+
+    size_t entry_idx = static_cast<size_t>(x + y * REGION_LENGTH + z * REGION_AREA);
+
+    return 2 * sizeof(ui32) + entry_idx * sizeof(hvox::RegionFileEntry);
+}
+
+static void compress(const std::vector<ui8>& data, OUT std::vector<char>& compressed) {
+    bio::filtering_ostream stream;
+    stream.push(bio::zlib_compressor(bio::zlib::best_speed));
+    stream.push(bio::back_inserter(compressed));
+
+    stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    // Flushes the compressor into the buffer.
+    stream.reset();
+}
+
+static bool decompress(const char* data, size_t size, OUT std::vector<char>& decompressed) {
+    try {
+        bio::filtering_istream stream;
+        stream.push(bio::zlib_decompressor());
+        stream.push(bio::array_source(data, size));
+
+        bio::copy(stream, bio::back_inserter(decompressed));
+    } catch (const bio::zlib_error&) {
+        return false;
+    }
+
+    return true;
+}
+
+hvox::ChunkRegionStore::ChunkRegionStore() :
+    m_iomanager(nullptr)
+{ /* Empty. */ }
+
+void hvox::ChunkRegionStore::init( io::IOManagerBase* iomanager,
+                                    const io::fs::path& directory,
+                                                   ui32 thread_count /*= 1*/ )
+{
+    m_iomanager = iomanager;
+    m_directory = directory;
+
+    m_iomanager->create_directories(m_directory);
+
+    m_thread_pool.init(thread_count);
+}
+
+void hvox::ChunkRegionStore::dispose() {
+    m_thread_pool.dispose();
+
+    // Any saves whose tasks did not get to run are
+    // written now, on the calling thread.
+    std::vector<ChunkID> pending;
+    {
+        std::lock_guard lock(m_pending_saves_mutex);
+
+        pending.reserve(m_pending_saves.size());
+        for (auto& [id, payload] : m_pending_saves) pending.emplace_back(id);
+    }
+
+    for (auto id : pending) {
+        ChunkGridPosition position;
+        position.id = id;
+
+        write_pending(position);
+    }
+
+    std::unordered_map<ChunkID, Payload>().swap(m_pending_saves);
+    std::unordered_map<RegionID, std::unique_ptr<std::shared_mutex>>().swap(m_region_mutexes);
+}
+
+bool hvox::ChunkRegionStore::load(hmem::Handle<Chunk> chunk) {
+    Payload pending = nullptr;
+    {
+        std::lock_guard lock(m_pending_saves_mutex);
+
+        auto it = m_pending_saves.find(chunk->position.id);
+        if (it != m_pending_saves.end()) pending = it->second;
+    }
+
+    if (pending) {
+        std::unique_lock lock(chunk->blocks_mutex);
+
+        if (!chunk->blocks.deserialise(pending->data(), pending->size())) return false;
+
+        chunk->modified.store(false, std::memory_order_release);
+
+        return true;
+    }
+
+    std::vector<char> payload;
+    if (!read_payload(chunk->position, payload)) return false;
+
+    std::unique_lock lock(chunk->blocks_mutex);
+
+    if (!chunk->blocks.deserialise(reinterpret_cast<const ui8*>(payload.data()), payload.size())) return false;
+
+    chunk->modified.store(false, std::memory_order_release);
+
+    return true;
+}
+
+bool hvox::ChunkRegionStore::save(hmem::Handle<Chunk> chunk) {
+    // Chunks that never finished generating have
+    // nothing worth saving.
+    if (chunk->state.load(std::memory_order_acquire) < ChunkState::GENERATED) return false;
+
+    auto payload = std::make_shared<std::vector<ui8>>();
+    {
+        std::shared_lock lock(chunk->blocks_mutex);
+
+        // Cleared with the blocks locked, such that any change
+        // not in this snapshot marks the chunk modified anew.
+        chunk->modified.store(false, std::memory_order_release);
+
+        chunk->blocks.serialise(*payload);
+    }
+
+    bool task_queued;
+    {
+        std::lock_guard lock(m_pending_saves_mutex);
+
+        auto& slot  = m_pending_saves[chunk->position.id];
+        task_queued = slot != nullptr;
+        slot        = payload;
+    }
+
+    // If a save of this chunk is already pending, its
+    // task will pick up the newer snapshot.
+    if (task_queued) return true;
+
+    ChunkSaveTask* task = new ChunkSaveTask();
+    task->init(chunk->position, this, m_iomanager);
+    m_thread_pool.threadsafe_add_task({task, true});
+
+    return true;
+}
+
+bool hvox::ChunkRegionStore::write_pending(ChunkGridPosition chunk_position) {
+    Payload payload = nullptr;
+    {
+        std::lock_guard lock(m_pending_saves_mutex);
+
+        auto it = m_pending_saves.find(chunk_position.id);
+        if (it == m_pending_saves.end()) return true;
+
+        payload = it->second;
+    }
+
+    while (true) {
+        bool success = write_payload(chunk_position, *payload);
+
+        std::lock_guard lock(m_pending_saves_mutex);
+
+        auto it = m_pending_saves.find(chunk_position.id);
+        if (it == m_pending_saves.end()) return success;
+
+        // Only drop the snapshot once it is on disk, and
+        // only if no newer one was made while writing.
+        if (it->second == payload || !success) {
+            if (success) m_pending_saves.erase(it);
+
+            return success;
+        }
+
+        payload = it->second;
+    }
+}
+
+hio::fs::path hvox::ChunkRegionStore::region_path(ChunkGridPosition region_position) const {
+    return m_directory / (
+        "r." + std::to_string(region_position.x)
+            + "." + std::to_string(region_position.y)
+            + "." + std::to_string(region_position.z)
+            + ".hrg"
+    );
+}
+
+std::shared_mutex& hvox::ChunkRegionStore::region_mutex(RegionID id) {
+    std::lock_guard lock(m_region_mutexes_mutex);
+
+    auto& mutex = m_region_mutexes[id];
+    if (mutex == nullptr) mutex = std::make_unique<std::shared_mutex>();
+
+    return *mutex;
+}
+
+bool hvox::ChunkRegionStore::read_payload(ChunkGridPosition chunk_position, OUT std::vector<char>& payload) {
+    ChunkGridPosition region = region_position(chunk_position);
+
+    io::fs::path path = region_path(region);
+
+    std::shared_lock lock(region_mutex(region.id));
+
+    if (!m_iomanager->can_access_file(path)) return false;
+
+    io::fs::mapped_file_source file;
+    if (!m_iomanager->memory_map_read_only_file(path, file)) return false;
+
+    if (file.size() < REGION_FILE_HEADER_SIZE) return false;
+
+    const char* data = file.data();
+
+    ui32 magic, version;
+    std::memcpy(&magic,   data,               sizeof(ui32));
+    std::memcpy(&version, data + sizeof(ui32), sizeof(ui32));
+    if (magic != REGION_FILE_MAGIC || version != REGION_FILE_VERSION) return false;
+
+    RegionFileEntry entry;
+    std::memcpy(&entry, data + region_entry_offset(chunk_position, region), sizeof(RegionFileEntry));
+
+    if (entry.size == 0) return false;
+    // Written so as not to wrap for offsets near the limit of
+    // their type, as a corrupt entry may hold.
+    if (entry.offset > file.size() || entry.size > file.size() - entry.offset) return false;
+
+    return decompress(data + entry.offset, entry.size, payload);
+}
+
+bool hvox::ChunkRegionStore::write_payload(ChunkGridPosition chunk_position, const std::vector<ui8>& payload) {
+    std::vector<char> compressed;
+    compress(payload, compressed);
+
+    ChunkGridPosition region = region_position(chunk_position);
+
+    io::fs::path path{};
+    if (!m_iomanager->resolve_path(region_path(region), path)) return false;
+
+    std::unique_lock lock(region_mutex(region.id));
+
+    if (!io::fs::exists(path)) {
+        std::ofstream create(path, std::ios::binary);
+        if (!create) return false;
+
+        create.write(reinterpret_cast<const char*>(&REGION_FILE_MAGIC),   sizeof(ui32));
+        create.write(reinterpret_cast<const char*>(&REGION_FILE_VERSION), sizeof(ui32));
+
+        std::vector<char> entries(REGION_VOLUME * sizeof(RegionFileEntry), 0);
+        create.write(entries.data(), static_cast<std::streamsize>(entries.size()));
+
+        if (!create) return false;
+    }
+
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file) return false;
+
+    ui32 magic, version;
+    file.read(reinterpret_cast<char*>(&magic),   sizeof(ui32));
+    file.read(reinterpret_cast<char*>(&version), sizeof(ui32));
+    if (!file || magic != REGION_FILE_MAGIC || version != REGION_FILE_VERSION) return false;
+
+    const size_t entry_offset = region_entry_offset(chunk_position, region);
+
+    RegionFileEntry entry;
+    file.seekg(static_cast<std::streamoff>(entry_offset));
+    file.read(reinterpret_cast<char*>(&entry), sizeof(RegionFileEntry));
+    if (!file) return false;
+
+    const ui32 size = static_cast<ui32>(compressed.size());
+
+    if (size <= entry.capacity) {
+        file.seekp(static_cast<std::streamoff>(entry.offset));
+        file.write(compressed.data(), size);
+    } else {
+        // The old space, if any, is abandoned. Reclaiming it
+        // is left to a future compaction of the region file.
+        file.seekp(0, std::ios::end);
+
+        entry.offset   = static_cast<ui64>(file.tellp());
+        entry.capacity = ((size + REGION_FILE_PAYLOAD_ALIGNMENT - 1) / REGION_FILE_PAYLOAD_ALIGNMENT)
+                            * REGION_FILE_PAYLOAD_ALIGNMENT;
+
+        // Pad out to the full capacity so that the next
+        // appended payload does not overlap this one.
+        compressed.resize(entry.capacity, 0);
+        file.write(compressed.data(), entry.capacity);
+    }
+
+    entry.size = size;
+
+    file.seekp(static_cast<std::streamoff>(entry_offset));
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(RegionFileEntry));
+
+    return static_cast<bool>(file);
+}
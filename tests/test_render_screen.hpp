@@ -161,7 +161,7 @@ public:
         glBindTextureUnit(0, m_default_texture);
         glUniform1i(m_shader.uniform_location("tex"), 0);
 
-        m_chunk_grid->draw(time);
+        m_chunk_grid->draw(time, &m_camera);
 
         // Deactivate our shader.
         m_shader.unuse();
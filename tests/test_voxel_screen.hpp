@@ -6,11 +6,17 @@
 #include <FastNoise/FastNoise.h>
 
 #include "memory/handle.hpp"
+#include "voxel/chunk/edit_batch.h"
 #include "voxel/chunk/generator_task.hpp"
+#include "voxel/chunk/mesh/binary_greedy_task.hpp"
 #include "voxel/chunk/mesh/greedy_task.hpp"
+#include "voxel/io/chunk_load_task.h"
+#include "voxel/io/region_store.h"
 #include "voxel/ray.h"
 
+#include "physics/voxel/chunk_collider_cache.hpp"
 #include "physics/voxel/chunk_grid_collider.hpp"
+#include "physics/world.h"
 
 #include "iomanager.hpp"
 
@@ -26,7 +32,11 @@ struct TVS_BlockComparator {
     }
 };
 struct TVS_VoxelGenerator {
-    void operator() (hmem::Handle<hvox::Chunk> chunk) const {
+    // Built just the once per worker thread, see
+    // hvox::ChunkGenerationStrategy.
+    TVS_VoxelGenerator() :
+        noise(CHUNK_VOLUME)
+    {
         auto simplex_1                  = FastNoise::New<FastNoise::Simplex>();
         auto fractal_1                  = FastNoise::New<FastNoise::FractalFBm>();
         auto domain_scale_1             = FastNoise::New<FastNoise::DomainScale>();
@@ -60,10 +70,114 @@ struct TVS_VoxelGenerator {
         domain_warp_fract_prog_1->SetOctaveCount(2);
         domain_warp_fract_prog_1->SetLacunarity(2.5f);
 
-        f32* data = new f32[CHUNK_VOLUME];
-        domain_warp_fract_prog_1->GenUniformGrid3D(
-        // domain_warp_grad_1->GenUniformGrid3D(
-        // fractal_1.get()->GenUniformGrid3D(
+        generator = domain_warp_fract_prog_1;
+    }
+
+    // Chunks in these layers, those streamed in, have their noise
+    // generated a whole column at a time and shared through the
+    // column cache.
+    static constexpr i32    MIN_CHUNK_Y             = -2;
+    static constexpr i32    MAX_CHUNK_Y             = 5;
+    static constexpr i32    COLUMN_HEIGHT           = (MAX_CHUNK_Y - MIN_CHUNK_Y + 1) * CHUNK_LENGTH;
+    static constexpr size_t COLUMN_CACHE_CAPACITY   = 256;
+
+    static_assert(CHUNK_LENGTH <= 32, "Rows of a column are held in 32-bit masks.");
+
+    struct ColumnData {
+        // Bit x of row y + z * COLUMN_HEIGHT is set if the block at x
+        // and z, y blocks down from the top of the column, is solid.
+        std::vector<ui32>   solid;
+        // World height of the highest solid block of the column.
+        i32                 max_height;
+    };
+
+    void generate_column(hvox::ColumnWorldPosition column, ColumnData& data) {
+        column_noise.resize(CHUNK_AREA * COLUMN_HEIGHT);
+
+        generator->GenUniformGrid3D(
+            column_noise.data(),
+            column.x,
+            -1 * MAX_CHUNK_Y * CHUNK_LENGTH,
+            column.z,
+            CHUNK_LENGTH,
+            COLUMN_HEIGHT,
+            CHUNK_LENGTH,
+            0.005f,
+            1337
+        );
+
+        data.solid.assign(CHUNK_LENGTH * COLUMN_HEIGHT, 0);
+        data.max_height = MIN_CHUNK_Y * CHUNK_LENGTH - 1;
+
+        size_t noise_idx = 0;
+        for (i32 z = 0; z < CHUNK_LENGTH; ++z) {
+            for (i32 y = 0; y < COLUMN_HEIGHT; ++y) {
+                ui32& row = data.solid[static_cast<size_t>(y + z * COLUMN_HEIGHT)];
+
+                for (i32 x = 0; x < CHUNK_LENGTH; ++x) {
+                    if (column_noise[noise_idx++] > 0) row |= ui32{1} << x;
+                }
+
+                if (row != 0)
+                    data.max_height = std::max(data.max_height, (MAX_CHUNK_Y + 1) * CHUNK_LENGTH - 1 - y);
+            }
+        }
+    }
+
+    void operator() (hmem::Handle<hvox::Chunk> chunk, const ColumnData& column) {
+        const i32 chunk_y = static_cast<i32>(chunk->position.y);
+
+        if (chunk_y < MIN_CHUNK_Y || chunk_y > MAX_CHUNK_Y) {
+            generate_chunk(chunk);
+            return;
+        }
+
+        // Chunks wholly above the surface are left as air.
+        if (chunk_y * CHUNK_LENGTH > column.max_height) return;
+
+        // The row of the column holding the top layer of the chunk.
+        const i32 top = (MAX_CHUNK_Y - chunk_y) * CHUNK_LENGTH;
+
+        // Chunks wholly solid or wholly air are filled in one go,
+        // leaving them uniform.
+        const ui32 full_row = ~ui32{0} >> (32 - CHUNK_LENGTH);
+
+        bool all_solid = true, all_air = true;
+        for (i32 z = 0; z < CHUNK_LENGTH; ++z) {
+            for (i32 y = 0; y < CHUNK_LENGTH; ++y) {
+                ui32 row = column.solid[static_cast<size_t>(top + y + z * COLUMN_HEIGHT)];
+
+                all_solid = all_solid && row == full_row;
+                all_air   = all_air   && row == 0;
+            }
+        }
+
+        if (all_air) return;
+
+        std::lock_guard lock(chunk->blocks_mutex);
+
+        if (all_solid) {
+            chunk->blocks.fill(hvox::Block{1});
+            return;
+        }
+
+        for (ui8 z = 0; z < CHUNK_LENGTH; ++z) {
+            for (ui8 y = 0; y < CHUNK_LENGTH; ++y) {
+                ui32 row = column.solid[static_cast<size_t>(top + y + z * COLUMN_HEIGHT)];
+
+                for (ui8 x = 0; x < CHUNK_LENGTH; ++x) {
+                    chunk->blocks.set(
+                        hvox::block_index({x, CHUNK_LENGTH - y - 1, z}),
+                        (row >> x) & 1 ? hvox::Block{1} : hvox::Block{0}
+                    );
+                }
+            }
+        }
+    }
+
+    void generate_chunk(hmem::Handle<hvox::Chunk> chunk) {
+        f32* data = noise.data();
+        generator->GenUniformGrid3D(
             data,
             static_cast<int>(chunk->position.x) * CHUNK_LENGTH,
             -1 * static_cast<int>(chunk->position.y) * CHUNK_LENGTH,
@@ -94,7 +208,10 @@ struct TVS_VoxelGenerator {
             for (ui8 z = 0; z < CHUNK_LENGTH; ++z) {
                 for (ui8 y = 0; y < CHUNK_LENGTH; ++y) {
                     for (ui8 x = 0; x < CHUNK_LENGTH; ++x) {
-                        chunk->blocks[hvox::block_index({x, CHUNK_LENGTH - y - 1, z})] = data[noise_idx++] > 0 ? hvox::Block{1} : hvox::Block{0};
+                        chunk->blocks.set(
+                            hvox::block_index({x, CHUNK_LENGTH - y - 1, z}),
+                            data[noise_idx++] > 0 ? hvox::Block{1} : hvox::Block{0}
+                        );
                     }
                 }
             }
@@ -113,15 +230,28 @@ struct TVS_VoxelGenerator {
         //         hvox::set_blocks(chunk, {x, 0, z}, {x, glm::min(height - y, CHUNK_LENGTH - 1), z}, hvox::Block{1});
         //     }
         // }
-
-        delete[] data;
     }
+
+    FastNoise::SmartNode<>  generator;
+    std::vector<f32>        noise;
+    std::vector<f32>        column_noise;
 };
 
 struct TVS_VoxelShapeEvaluator {
     btCollisionShape* operator()(hvox::Block b, btTransform&) const {
+        static btBoxShape block_shape = btBoxShape(btVector3{0.5f, 0.5f, 0.5f});
+
+        if (b == hvox::Block{1}) {
+            return &block_shape;
+        }
+        return nullptr;
+    }
+};
+
+struct TVS_VoxelPrototypeEvaluator {
+    const hphys::VoxelShapePrototype* operator()(hvox::Block b) const {
         if (b == hvox::Block{1}) {
-            return new btBoxShape(btVector3{0.5f, 0.5f, 0.5f});
+            return &hphys::VoxelShapePrototype::unit_cube();
         }
         return nullptr;
     }
@@ -202,28 +332,11 @@ public:
 
     virtual void start(hemlock::FrameTime time) override {
         happ::ScreenBase::start(time);
-
-        for (auto x = -VIEW_DIST; x <= VIEW_DIST; ++x) {
-            for (auto z = -VIEW_DIST; z <= VIEW_DIST; ++z) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_chunk_grid->preload_chunk_at({ {x, y, z} });
-                }
-            }
-        }
-        for (auto x = -VIEW_DIST; x <= VIEW_DIST; ++x) {
-            for (auto z = -VIEW_DIST; z <= VIEW_DIST; ++z) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_chunk_grid->load_chunk_at({ {x, y, z} });
-                }
-            }
-        }
     }
 
     virtual void update(hemlock::FrameTime time) override {
-        static f32v3 last_pos{0.0f};
-
         if (m_input_manager->is_pressed(hui::PhysicalKey::H_G)) {
-            m_phys.world->setGravity(btVector3(0, -9.8f, 0));
+            m_phys->setGravity(btVector3(0, -9.8f, 0));
             debug_printf("Turning on gravity.\n");
         }
 
@@ -313,102 +426,14 @@ public:
         }
         m_camera.update();
 
-        f32v3 current_pos = glm::floor(m_camera.position() / static_cast<f32>(CHUNK_LENGTH));
-
-        i32 x_step = static_cast<i32>(current_pos.x) - static_cast<i32>(last_pos.x);
-        if (x_step != 0) {
-            for (auto z = static_cast<i32>(current_pos.z) - VIEW_DIST; z <= static_cast<i32>(current_pos.z) + VIEW_DIST; ++z) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_unloading_chunks.emplace_back(hmem::WeakHandle<hvox::Chunk>{});
-                    auto& handle = m_unloading_chunks.back();
-                    m_chunk_grid->unload_chunk_at({ {
-                        x_step < 0 ? static_cast<i32>(current_pos.x) + VIEW_DIST + 1 : static_cast<i32>(current_pos.x) - VIEW_DIST - 1,
-                        y, z
-                    } }, &handle);
-                }
-            }
-            for (auto z = static_cast<i32>(current_pos.z) - VIEW_DIST; z <= static_cast<i32>(current_pos.z) + VIEW_DIST; ++z) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_chunk_grid->preload_chunk_at({ {
-                        x_step < 0 ? static_cast<i32>(current_pos.x) - VIEW_DIST : static_cast<i32>(current_pos.x) + VIEW_DIST,
-                        y, z
-                    } });
-                }
-            }
-            for (auto z = static_cast<i32>(current_pos.z) - VIEW_DIST; z <= static_cast<i32>(current_pos.z) + VIEW_DIST; ++z) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_chunk_grid->load_chunk_at({ {
-                        x_step < 0 ? static_cast<i32>(current_pos.x) - VIEW_DIST : static_cast<i32>(current_pos.x) + VIEW_DIST,
-                        y, z
-                    } });
-                }
-            }
-        }
-
-        i32 z_step = static_cast<i32>(current_pos.z) - static_cast<i32>(last_pos.z);
-        if (z_step != 0) {
-            for (auto x = static_cast<i32>(current_pos.x) - VIEW_DIST; x <= static_cast<i32>(current_pos.x) + VIEW_DIST; ++x) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_unloading_chunks.emplace_back(hmem::WeakHandle<hvox::Chunk>{});
-                    auto& handle = m_unloading_chunks.back();
-                    m_chunk_grid->unload_chunk_at({ {
-                        x, y,
-                        z_step < 0 ? static_cast<i32>(current_pos.z) + VIEW_DIST + 1 : static_cast<i32>(current_pos.z) - VIEW_DIST - 1
-                    } }, &handle);
-                }
-            }
-            for (auto x = static_cast<i32>(current_pos.x) - VIEW_DIST; x <= static_cast<i32>(current_pos.x) + VIEW_DIST; ++x) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_chunk_grid->preload_chunk_at({ {
-                        x, y,
-                        z_step < 0 ? static_cast<i32>(current_pos.z) - VIEW_DIST : static_cast<i32>(current_pos.z) + VIEW_DIST
-                    } });
-                }
-            }
-            for (auto x = static_cast<i32>(current_pos.x) - VIEW_DIST; x <= static_cast<i32>(current_pos.x) + VIEW_DIST; ++x) {
-                for (auto y = -2; y < 6; ++ y) {
-                    m_chunk_grid->load_chunk_at({ {
-                        x, y,
-                        z_step < 0 ? static_cast<i32>(current_pos.z) - VIEW_DIST : static_cast<i32>(current_pos.z) + VIEW_DIST
-                    } });
-                }
-            }
-        }
-
-        last_pos = current_pos;
-
+        m_chunk_grid->update_streaming(m_camera.position());
+        m_chunk_grid->update_render_states(m_camera.position());
         m_chunk_grid->update(time);
 
-        static btRigidBody*     voxel_patch_body    = nullptr;
-        static btCompoundShape* voxel_patch         = nullptr;
-
-        if (voxel_patch_body) {
-            m_phys.world->removeRigidBody(voxel_patch_body);
-            delete voxel_patch_body;
-            voxel_patch_body = nullptr;
-        }
-        if (voxel_patch) {
-            delete voxel_patch;
-            voxel_patch = nullptr;
-        }
-
-        voxel_patch = new btCompoundShape();
-        if (hphys::ChunkGridCollider::determine_candidate_colliding_voxels<TVS_VoxelShapeEvaluator>(m_player.ac, m_player.dc, m_player.cc, voxel_patch)) {
-            btTransform transform = btTransform::getIdentity();
-            transform.setOrigin(btVector3(glm::floor(m_camera.position().x), glm::floor(m_camera.position().y), glm::floor(m_camera.position().z)));
-            btDefaultMotionState* motion_state = new btDefaultMotionState(transform);
-            btVector3 inertia;
-            btScalar mass = 0.0f;
-            voxel_patch->calculateLocalInertia(mass, inertia);
-            btRigidBody::btRigidBodyConstructionInfo body_info = btRigidBody::btRigidBodyConstructionInfo(mass, motion_state, voxel_patch, inertia);
-            body_info.m_restitution = 0.0f;
-            body_info.m_friction = 1.0f;
-            voxel_patch_body = new btRigidBody(body_info);
-            m_phys.world->addRigidBody(voxel_patch_body);
-        }
+        m_voxel_colliders.update();
 
         m_player_body->activate();
-        m_phys.world->stepSimulation(hemlock::frame_time_to_floating<std::chrono::seconds, btScalar>(time));
+        m_phys.step(time);
 
         m_camera.set_position(f32v3{
             m_player_body->getWorldTransform().getOrigin().x(),
@@ -443,20 +468,7 @@ public:
             } else {
                 debug_printf("No voxels in voxel patch.\n");
             }
-
-            debug_printf("Chunks still not unloaded:\n");
-            for (auto& handle : m_unloading_chunks) {
-                if (handle.expired()) continue;
-
-                auto chunk = handle.lock();
-
-                if (
-                    (chunk->position.x < static_cast<i32>(current_pos.x) - VIEW_DIST) || (chunk->position.x > static_cast<i32>(current_pos.x) - VIEW_DIST) ||
-                    (chunk->position.z < static_cast<i32>(current_pos.z) - VIEW_DIST) || (chunk->position.z > static_cast<i32>(current_pos.z) - VIEW_DIST)
-                ) {
-                    debug_printf("    (%d, %d, %d)\n", chunk->position.x, chunk->position.y, chunk->position.z);
-                }
-            }
+            delete _voxel_patch;
         }
     }
     virtual void draw(hemlock::FrameTime time) override {
@@ -469,14 +481,14 @@ public:
         glBindTextureUnit(0, m_default_texture);
         glUniform1i(m_shader.uniform_location("tex"), 0);
 
-        m_chunk_grid->draw(time);
+        m_chunk_grid->draw(time, &m_camera);
 
         // Deactivate our shader.
         m_shader.unuse();
 
         m_line_shader.use();
 
-        m_phys.world->debugDrawWorld();
+        m_phys->debugDrawWorld();
 
         f32v3 line_colour{1.0f};
 
@@ -565,16 +577,28 @@ public:
             workflow_builder.init(&m_chunk_load_dag);
             workflow_builder.chain_tasks(2);
         }
+        m_region_store = hmem::make_handle<hvox::ChunkRegionStore>();
+        m_region_store->init(&m_iom, "saves/test_voxel");
+
         m_chunk_grid = hmem::make_handle<hvox::ChunkGrid>();
         m_chunk_grid->init(
             m_chunk_grid,
             10,
             hvox::ChunkTaskBuilder{[]() {
-                return new hvox::ChunkGenerationTask<TVS_VoxelGenerator>();
+                return new hvox::ChunkLoadTask<TVS_VoxelGenerator>();
             }}, hvox::ChunkTaskBuilder{[]() {
-                return new hvox::ChunkGreedyMeshTask<TVS_BlockComparator>();
-            }}
+                return new hvox::ChunkBinaryGreedyMeshTask<TVS_BlockComparator>();
+            }},
+            m_region_store
         );
+        m_chunk_grid->set_lod_distance(VIEW_DIST / 2);
+        m_chunk_grid->set_streaming({
+            hvox::ChunkStreamShape::CYLINDER,
+            VIEW_DIST,
+            TVS_VoxelGenerator::MIN_CHUNK_Y,
+            TVS_VoxelGenerator::MAX_CHUNK_Y,
+            32
+        });
 
         m_player.ac.position   = hvox::EntityWorldPosition{0, static_cast<hvox::EntityWorldPositionCoord>(60) << 32, 0};
         m_player.ac.chunk_grid = m_chunk_grid;
@@ -583,14 +607,13 @@ public:
         // TODO(Matthew): update this.
         m_player.dc.velocity   = f32v3(2.0f);
 
-        m_phys.broadphase       = new btDbvtBroadphase();
-        m_phys.collision_config = new btDefaultCollisionConfiguration();
-        m_phys.dispatcher       = new btCollisionDispatcher(m_phys.collision_config);
-        m_phys.solver           = new btSequentialImpulseConstraintSolver();
-        m_phys.world            = new btDiscreteDynamicsWorld(m_phys.dispatcher, m_phys.broadphase, m_phys.solver, m_phys.collision_config);
-        m_phys.world->setGravity(btVector3(0, 0, 0));
-        m_phys.world->setDebugDrawer(new VoxelPhysDrawer(&m_camera, &m_line_shader));
-        m_phys.world->getDebugDrawer()->setDebugMode(btIDebugDraw::DBG_DrawWireframe);
+        // Physics takes whichever cores are left over by this
+        // thread and the chunk grid's 10 threads.
+        const ui32 core_count = std::thread::hardware_concurrency();
+        m_phys.init(core_count > 12 ? core_count - 11 : 1);
+        m_phys->setGravity(btVector3(0, 0, 0));
+        m_phys->setDebugDrawer(new VoxelPhysDrawer(&m_camera, &m_line_shader));
+        m_phys->getDebugDrawer()->setDebugMode(btIDebugDraw::DBG_DrawWireframe);
 
         {
             btQuaternion rotation;
@@ -605,9 +628,11 @@ public:
             body_info.m_friction = 1000.0f;
             m_player_body = new btRigidBody(body_info);
             m_player_body->setAngularFactor(0.0f);
-            m_phys.world->addRigidBody(m_player_body);
+            m_phys->addRigidBody(m_player_body);
         }
 
+        m_voxel_colliders.init(m_chunk_grid, m_phys.world());
+
         glCreateVertexArrays(1, &m_crosshair_vao);
 
         glCreateBuffers(1, &m_crosshair_vbo);
@@ -637,6 +662,27 @@ public:
                             hvox::set_block(chunk, hvox::block_chunk_position(position), hvox::Block{1});
                         }
                     }
+                } else if (ev.button_id == static_cast<ui8>(hui::MouseButton::RIGHT)) {
+                    hvox::BlockWorldPosition position;
+                    f32 distance;
+
+                    // Blasts a sphere out of the terrain, which may
+                    // span many chunks, as a single batch of edits.
+                    if (hvox::Ray::cast_to_block(m_camera.position(), m_camera.direction(), m_chunk_grid, hvox::Block{1}, 50, position, distance)) {
+                        const i32 radius = 6;
+
+                        hvox::BlockEditBatch batch;
+                        for (i32 z = -radius; z <= radius; ++z) {
+                            for (i32 y = -radius; y <= radius; ++y) {
+                                for (i32 x = -radius; x <= radius; ++x) {
+                                    if (x * x + y * y + z * z > radius * radius) continue;
+
+                                    batch.set_block(position + hvox::BlockWorldPosition{x, y, z}, hvox::Block{0});
+                                }
+                            }
+                        }
+                        batch.commit(m_chunk_grid);
+                    }
                 }
             }
         };
@@ -667,6 +713,7 @@ protected:
     hcam::BasicFirstPersonCamera m_camera;
     hui::InputManager*           m_input_manager;
     hmem::Handle<hvox::ChunkGrid>   m_chunk_grid;
+    hmem::Handle<hvox::ChunkRegionStore> m_region_store;
     hg::GLSLProgram              m_shader, m_line_shader;
     hthread::ThreadWorkflowDAG   m_chunk_load_dag;
     struct {
@@ -675,19 +722,12 @@ protected:
         hphys::DynamicComponent    dc;
     } m_player;
     btRigidBody* m_player_body;
-    struct {
-        btDbvtBroadphase*                       broadphase;
-        btDefaultCollisionConfiguration*        collision_config;
-        btCollisionDispatcher*                  dispatcher;
-        btSequentialImpulseConstraintSolver*    solver;
-        btDiscreteDynamicsWorld*                world;
-    } m_phys;
+    hphys::ChunkColliderCache<TVS_VoxelPrototypeEvaluator> m_voxel_colliders;
+    hphys::PhysicsWorld m_phys;
 
     bool m_draw_chunk_outlines;
 
     GLuint m_crosshair_vao, m_crosshair_vbo;
-
-    std::vector<hmem::WeakHandle<hvox::Chunk>> m_unloading_chunks;
 };
 
 #endif // __hemlock_tests_test_voxel_screen_hpp